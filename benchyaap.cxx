@@ -0,0 +1,292 @@
+//! \file benchyaap.cxx
+//! \brief Benchmarks of the yaap parsing paths
+//!
+//! Built with the YAAP_BUILD_BENCHMARKS CMake option, on top of Google
+//! Benchmark. For instance:
+//!   [shell]$ yaap_bench --benchmark_filter=Layout
+//! The yaap_bench_json target runs them all and writes yaap_bench.json in the
+//! build directory, to be compared from one version to the next, e.g. with
+//! Google Benchmark's tools/compare.py.
+
+#include "yaap.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//! Argument vector kept alive for the whole benchmark run
+class CommandLine {
+public:
+    CommandLine( const char* const* args, std::size_t nb )
+        : strings( args, args + nb )
+    {
+        this->Link();
+    };
+
+    CommandLine( const std::vector<std::string>& args )
+        : strings( args )
+    {
+        this->Link();
+    };
+
+    int Argc( ) {
+        return( static_cast<int>( this->strings.size() ) );
+    };
+
+    char** Argv( ) {
+        return( &this->argv[0] );
+    };
+
+private:
+    void Link( )
+    {
+        for( std::size_t i = 0; i < strings.size(); i++ )
+            this->argv.push_back( &this->strings[i][0] );
+        this->argv.push_back( NULL );
+    };
+
+    std::vector<std::string> strings;
+    std::vector<char*> argv;
+};
+
+//! Name of the k-th generated option, e.g. "opt12"
+static std::string OptionName( unsigned int k )
+{
+    char name[16];
+    std::snprintf( name, sizeof( name ), "opt%u", k );
+    return( name );
+}
+
+//! Comma list of the n first integers, printed with format
+static std::string MakeList( unsigned int n, const char* format )
+{
+    std::string list;
+    char value[16];
+    for( unsigned int k = 0; k < n; k++ )
+    {
+        std::snprintf( value, sizeof( value ), format, k );
+        if( k > 0 )
+            list += ',';
+        list += value;
+    }
+    return( list );
+}
+
+static CommandLine& TestCommandLine( )
+{
+    static const char* const args[] = {
+        "testyaap", "-i", "inputfile.txt", "-vV", "-o", "outputfile.raw",
+        "-s", ".558", ".558", "0.89", "-t", "0xF2", "-e", "0", "127", "0",
+        "127", "0", "127", "--ids", "1,2,3,4,5,6,7,8", "--", "operand"
+    };
+    static CommandLine commandLine( args, sizeof( args ) / sizeof( args[0] ) );
+    return( commandLine );
+}
+
+//! Layout of testyaap.cxx
+static yaap::Layout MakeTestLayout( )
+{
+    yaap::Layout layout;
+    layout.AddOptionArg<std::string>( 'i', "inputFile", "Input file (.vti)", 1, true );
+    layout.AddOptionArg<int>( 'e', "extent", "Extent", 6 );
+    layout.AddOptionArg<double>( 's', "spacing", "Spacing", 3, true );
+    layout.AddOptionArg<std::string>( 'o', "outputFile", "Output file (.vti)", 1, true );
+    layout.AddOptionArg<unsigned int>( 't', "tag", "UINT Tag", 1, true );
+    layout.AddOptionArg<int>( 'l', "ids", "Identifiers", yaap::undef );
+    layout.AddOption( 'v', "verbose", "Verbose output" );
+    layout.AddOption( 'V', "display", "Display version" );
+    layout.AddOption( 'h', "help", "Display a brief help" );
+    return( layout );
+}
+
+//! Parse against one immutable Layout from a growing number of threads,
+//! each with its own ParseResult. Items per second should scale linearly.
+static void BM_LayoutParseConcurrent( benchmark::State& state )
+{
+    static const yaap::Layout layout = MakeTestLayout(); // shared, thread-safe initialization
+    CommandLine& commandLine = TestCommandLine();
+    yaap::ParseResult result;
+    for( auto _ : state )
+    {
+        layout.Parse( commandLine.Argc(), commandLine.Argv(), result );
+        benchmark::DoNotOptimize( result.IsCommandLineValid() );
+    }
+    state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_LayoutParseConcurrent )->ThreadRange( 1, 64 )->UseRealTime();
+
+//! Register K long options on a command line of N arguments, half of them
+//! options and half their values: the cost of the lookups as both grow
+static void BM_ParserOptionsByArguments( benchmark::State& state )
+{
+    unsigned int nbOptions = static_cast<unsigned int>( state.range( 0 ) );
+    unsigned int nbArgs = static_cast<unsigned int>( state.range( 1 ) );
+    std::vector<std::string> args( 1, "bench" );
+    for( unsigned int i = 0; i + 1 < nbArgs; i += 2 )
+    {
+        args.push_back( "--" + OptionName( ( i / 2 ) % nbOptions ) );
+        args.push_back( "1" );
+    }
+    std::vector<std::string> names;
+    for( unsigned int k = 0; k < nbOptions; k++ )
+        names.push_back( OptionName( k ) );
+    CommandLine commandLine( args );
+    for( auto _ : state )
+    {
+        yaap::Parser parser( commandLine.Argc(), commandLine.Argv() );
+        for( unsigned int k = 0; k < nbOptions; k++ )
+            parser.AddOptionArg<int>( '\0', names[k], "", 1 );
+        benchmark::DoNotOptimize( parser.IsCommandLineValid() );
+    }
+    state.SetComplexityN( static_cast<benchmark::IterationCount>( nbOptions ) * nbArgs );
+}
+BENCHMARK( BM_ParserOptionsByArguments )->ArgsProduct( { { 8, 64, 512 }, { 16, 256, 4096 } } )->Complexity();
+
+//! Split and convert a comma list of n integers
+static void BM_ParserCommaList( benchmark::State& state )
+{
+    unsigned int n = static_cast<unsigned int>( state.range( 0 ) );
+    std::vector<std::string> args;
+    args.push_back( "bench" );
+    args.push_back( "--ids" );
+    args.push_back( MakeList( n, "%u" ) );
+    CommandLine commandLine( args );
+    for( auto _ : state )
+    {
+        yaap::Parser parser( commandLine.Argc(), commandLine.Argv() );
+        yaap::OptionArg<int>* ids = parser.AddOptionArg<int>( 'l', "ids", "", yaap::undef );
+        benchmark::DoNotOptimize( ids->GetNumberOfArguments() );
+    }
+    state.SetBytesProcessed( state.iterations() * static_cast<int64_t>( args[2].size() ) );
+    state.SetItemsProcessed( state.iterations() * n );
+}
+BENCHMARK( BM_ParserCommaList )->RangeMultiplier( 8 )->Range( 8, 32768 );
+
+//! Convert n unsigned int given in hexadecimal
+static void BM_ParserUnsignedHex( benchmark::State& state )
+{
+    unsigned int n = static_cast<unsigned int>( state.range( 0 ) );
+    std::vector<std::string> args;
+    args.push_back( "bench" );
+    args.push_back( "--tags" );
+    args.push_back( MakeList( n, "0x%X" ) );
+    CommandLine commandLine( args );
+    for( auto _ : state )
+    {
+        yaap::Parser parser( commandLine.Argc(), commandLine.Argv() );
+        yaap::OptionArg<unsigned int>* tags = parser.AddOptionArg<unsigned int>( 't', "tags", "", yaap::undef );
+        benchmark::DoNotOptimize( tags->GetArgument( n - 1 ) );
+    }
+    state.SetItemsProcessed( state.iterations() * n );
+}
+BENCHMARK( BM_ParserUnsignedHex )->RangeMultiplier( 8 )->Range( 8, 32768 );
+
+//! Browse n operands as std::string
+static void BM_ParserStringOperands( benchmark::State& state )
+{
+    unsigned int n = static_cast<unsigned int>( state.range( 0 ) );
+    std::vector<std::string> args( 1, "bench" );
+    args.push_back( "-v" );
+    args.push_back( "--" );
+    for( unsigned int k = 0; k < n; k++ )
+        args.push_back( "/some/rather/long/path/to/a/file/" + OptionName( k ) + ".txt" );
+    CommandLine commandLine( args );
+    for( auto _ : state )
+    {
+        yaap::Parser parser( commandLine.Argc(), commandLine.Argv() );
+        parser.AddOption( 'v', "verbose", "" );
+        std::size_t length = 0;
+        yaap::OperandRange<std::string> operands = parser.Operands<std::string>();
+        for( yaap::OperandRange<std::string>::iterator it = operands.begin(); it != operands.end(); ++it )
+            length += ( *it ).size();
+        benchmark::DoNotOptimize( length );
+    }
+    state.SetItemsProcessed( state.iterations() * n );
+}
+BENCHMARK( BM_ParserStringOperands )->RangeMultiplier( 8 )->Range( 8, 32768 );
+
+//! Render the usage of testyaap.cxx in a new parser each time
+static void BM_UsageRender( benchmark::State& state )
+{
+    CommandLine& commandLine = TestCommandLine();
+    char buffer[4096];
+    for( auto _ : state )
+    {
+        yaap::Parser parser( commandLine.Argc(), commandLine.Argv(), "Benchmark" );
+        parser.AddOptionArg<std::string>( 'i', "inputFile", "Input file (.vti)", 1, true );
+        parser.AddOptionArg<int>( 'e', "extent", "Extent", 6 );
+        parser.AddOptionArg<double>( 's', "spacing", "Spacing", 3, true );
+        parser.AddOptionArg<std::string>( 'o', "outputFile", "Output file (.vti)", 1, true );
+        parser.AddOptionArg<unsigned int>( 't', "tag", "UINT Tag", 1, true );
+        parser.AddOptionArg<int>( 'l', "ids", "Identifiers", yaap::undef );
+        parser.AddOption( 'v', "verbose", "Verbose output" );
+        parser.AddOption( 'V', "display", "Display version" );
+        parser.AddOption( 'h', "help", "Display a brief help" );
+        benchmark::DoNotOptimize( parser.Usage( buffer, sizeof( buffer ) ) );
+    }
+}
+BENCHMARK( BM_UsageRender );
+
+//! Get the usage again from the same parser, which renders it only once
+static void BM_UsageCached( benchmark::State& state )
+{
+    CommandLine& commandLine = TestCommandLine();
+    yaap::Parser parser( commandLine.Argc(), commandLine.Argv(), "Benchmark" );
+    parser.AddOptionArg<std::string>( 'i', "inputFile", "Input file (.vti)", 1, true );
+    parser.AddOption( 'v', "verbose", "Verbose output" );
+    char buffer[4096];
+    for( auto _ : state )
+        benchmark::DoNotOptimize( parser.Usage( buffer, sizeof( buffer ) ) );
+}
+BENCHMARK( BM_UsageCached );
+
+//! Edit the value of the last option of a command line of N arguments, as
+//! typed in an interactive console, and validate it again
+static void BM_ParserUpdate( benchmark::State& state )
+{
+    unsigned int nbArgs = static_cast<unsigned int>( state.range( 0 ) );
+    std::vector<std::string> args( 1, "bench" );
+    for( unsigned int i = 0; i + 1 < nbArgs; i += 2 )
+    {
+        args.push_back( "--" + OptionName( ( i / 2 ) % 32 ) );
+        args.push_back( "1" );
+    }
+    CommandLine commandLine( args );
+    yaap::Parser parser( commandLine.Argc(), commandLine.Argv() );
+    for( unsigned int k = 0; k < 32; k++ )
+        parser.AddOptionArg<int>( '\0', OptionName( k ), "", 1 );
+    static const char* const keystrokes[] = { "4", "42", "421", "42", "4" };
+    unsigned int index = static_cast<unsigned int>( commandLine.Argc() - 1 );
+    unsigned int k = 0;
+    for( auto _ : state )
+        benchmark::DoNotOptimize( parser.Update( index, keystrokes[k++ % 5] ) );
+}
+BENCHMARK( BM_ParserUpdate )->RangeMultiplier( 8 )->Range( 8, 4096 );
+
+//! Build a Parser from a wide command line of N arguments, as wmain() gets
+//! it, mostly ASCII with a few accented values: the UTF-8 encoding cost
+static void BM_ParserWide( benchmark::State& state )
+{
+    unsigned int nbArgs = static_cast<unsigned int>( state.range( 0 ) );
+    std::vector<std::wstring> strings( 1, L"bench" );
+    for( unsigned int i = 0; i + 1 < nbArgs; i += 2 )
+    {
+        strings.push_back( L"--input-file" );
+        strings.push_back( i % 8 == 0 ? L"C:\\Donn\u00e9es\\r\u00e9sultat.txt" : L"C:\\Data\\result.txt" );
+    }
+    std::vector<wchar_t*> argv;
+    for( std::size_t k = 0; k < strings.size(); k++ )
+        argv.push_back( &strings[k][0] );
+    argv.push_back( NULL );
+    for( auto _ : state )
+    {
+        yaap::Parser parser( static_cast<int>( strings.size() ), &argv[0] );
+        benchmark::DoNotOptimize( parser.IsCommandLineValid() );
+    }
+    state.SetItemsProcessed( state.iterations() * nbArgs );
+}
+BENCHMARK( BM_ParserWide )->RangeMultiplier( 8 )->Range( 8, 4096 );
+
+BENCHMARK_MAIN();
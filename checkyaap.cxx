@@ -0,0 +1,1419 @@
+//! \file checkyaap.cxx
+//! \brief Behaviour tests of yaap
+//!
+//! Built with the YAAP_BUILD_TESTS CMake option (on by default) and run by
+//! ctest. Each Test function checks one feature on small command lines and
+//! on real files, written in the current directory and removed afterwards.
+//! A failed check prints its line and the test exits with a non-zero code:
+//!   [shell]$ ctest --output-on-failure
+
+#include "yaap.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef YAAP_HAS_MMAP
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+#ifdef YAAP_HAS_THREADS
+#include <thread>
+#endif
+
+//! Enumeration of TestConverters(), converted by name
+enum Color { Red, Green, Blue };
+
+namespace yaap {
+template<> struct Converter<Color> : EnumConverter<Color> {
+    static const EnumName<Color>* Names( ) {
+        static const EnumName<Color> names[] = { { "red", Red }, { "green", Green }, { "blue", Blue }, { NULL, Red } };
+        return( names );
+    };
+};
+}
+
+//! Integer of TestLazyConversion(), whose conversions are counted
+struct Counted {
+    int value;
+};
+
+static unsigned int nbConversions = 0;
+
+namespace yaap {
+template<> struct Converter<Counted> {
+    static const char* Convert( const char* first, const char* last, Counted& value )
+    {
+        nbConversions++;
+        return( Converter<int>::Convert( first, last, value.value ) );
+    };
+};
+}
+
+#ifdef YAAP_HAS_CXX17
+//! Options of TestFlaglessOptions(), --dry-run having no flag and -q no long name
+struct DryRun : yaap::Field<'\0'> {
+    static constexpr const char* longName = "dry-run";
+    static constexpr const char* description = "Show what would be done";
+};
+struct Jobs : yaap::Field<'j', int> {
+    static constexpr const char* longName = "jobs";
+    static constexpr const char* description = "Number of jobs";
+};
+struct Quiet : yaap::Field<'q'> {
+    static constexpr const char* longName = "";
+    static constexpr const char* description = "Quiet output";
+};
+typedef yaap::Schema<DryRun, Jobs, Quiet> FlaglessSchema;
+#endif
+
+static unsigned int nbChecks = 0;
+static unsigned int nbFailures = 0;
+
+//! Count a check and report it if condition is false
+static void Check( bool condition, const char* expression, int line )
+{
+    nbChecks++;
+    if( condition )
+        return;
+    nbFailures++;
+    std::fprintf( stderr, "checkyaap.cxx:%d: check failed: %s\n", line, expression );
+}
+
+#define CHECK( condition ) Check( ( condition ), #condition, __LINE__ )
+
+//! Argument vector of a test, after a program name
+class CommandLine {
+public:
+    CommandLine( ) {
+        this->strings.push_back( "checkyaap" );
+    };
+
+    CommandLine& operator<<( const std::string& arg )
+    {
+        this->strings.push_back( arg );
+        return( *this );
+    };
+
+    int Argc( ) const {
+        return( static_cast<int>( this->strings.size() ) );
+    };
+
+    //! argv, valid until the next call to operator<<
+    char** Argv( )
+    {
+        this->argv.clear();
+        for( std::size_t i = 0; i < this->strings.size(); i++ )
+            this->argv.push_back( &this->strings[i][0] );
+        this->argv.push_back( NULL );
+        return( &this->argv[0] );
+    };
+
+private:
+    std::vector<std::string> strings;
+    std::vector<char*> argv;
+};
+
+//! File of the current directory, removed by the destructor
+class TemporaryFile {
+public:
+    TemporaryFile( const std::string& name, const std::string& content ) : path( "yaap_check_" + name )
+    {
+        this->Write( content );
+    };
+
+    ~TemporaryFile( ) {
+        std::remove( this->path.c_str() );
+    };
+
+    const std::string& Path( ) const {
+        return( this->path );
+    };
+
+    //! '@' + path, as given in a command line
+    std::string Argument( ) const {
+        return( "@" + this->path );
+    };
+
+    //! Replace the content of the file
+    void Write( const std::string& content )
+    {
+        std::FILE* file = std::fopen( this->path.c_str(), "wb" );
+        if( file != NULL )
+        {
+            std::fwrite( content.data(), 1, content.size(), file );
+            std::fclose( file );
+        }
+    };
+
+    std::string Read( ) const
+    {
+        std::string content;
+        std::FILE* file = std::fopen( this->path.c_str(), "rb" );
+        if( file == NULL )
+            return( content );
+        char buffer[256];
+        std::size_t n;
+        while( ( n = std::fread( buffer, 1, sizeof( buffer ), file ) ) > 0 )
+            content.append( buffer, n );
+        std::fclose( file );
+        return( content );
+    };
+
+private:
+    std::string path;
+};
+
+//! Operands of parser after the last "--", as strings
+static std::vector<std::string> Operands( yaap::Parser& parser )
+{
+    std::vector<std::string> operands;
+    yaap::OperandRange<std::string> range = parser.Operands<std::string>();
+    for( yaap::OperandRange<std::string>::iterator it = range.begin(); it != range.end(); ++it )
+        operands.push_back( *it );
+    return( operands );
+}
+
+//! Operands of a command line made of the response file content
+static std::vector<std::string> Expand( const std::string& name, const std::string& content )
+{
+    TemporaryFile file( name, "-- " + content );
+    CommandLine line;
+    line << file.Argument();
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    CHECK( parser.ExpandResponseFiles() );
+    return( Operands( parser ) );
+}
+
+static void TestResponseFiles( )
+{
+    // white spaces separate, quotes group and a backslash escapes
+    std::vector<std::string> args = Expand( "quotes.rsp", "plain\t\"double quoted\"\n'single quoted' "
+                                            "back\\ slash \"in\\\"side\" 'raw\\q' mi\"x\"'ed' \"unterminated" );
+    CHECK( args.size() == 8 );
+    if( args.size() == 8 )
+    {
+        CHECK( args[0] == "plain" );
+        CHECK( args[1] == "double quoted" );
+        CHECK( args[2] == "single quoted" );
+        CHECK( args[3] == "back slash" );
+        CHECK( args[4] == "in\"side" );
+        CHECK( args[5] == "raw\\q" );
+        CHECK( args[6] == "mixed" );
+        CHECK( args[7] == "unterminated" );
+    }
+    CHECK( Expand( "empty.rsp", "" ).empty() );
+    CHECK( Expand( "blank.rsp", " \n\t \r\n" ).empty() );
+
+    // the options of the file are parsed as if given in the command line
+    {
+        TemporaryFile file( "options.rsp", "-o 'out file' -n 3 4" );
+        CommandLine line;
+        line << "-v" << file.Argument() << "-q";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        CHECK( parser.ExpandResponseFiles() );
+        yaap::Option* verbose = parser.AddOption( 'v', "verbose", "Verbose" );
+        yaap::Option* quiet = parser.AddOption( 'q', "quiet", "Quiet" );
+        yaap::OptionArg<std::string>* output = parser.AddOptionArg<std::string>( 'o', "output", "Output", 1 );
+        yaap::OptionArg<int>* number = parser.AddOptionArg<int>( 'n', "number", "Numbers", 2 );
+        CHECK( verbose->Exists() && quiet->Exists() );
+        CHECK( output->GetValue() == "out file" );
+        CHECK( number->GetArgument( 0 ) == 3 && number->GetArgument( 1 ) == 4 );
+        CHECK( parser.IsCommandLineValid() );
+    }
+
+    // a file whose size is a multiple of the page size ends without the
+    // zero byte of a partial last page: it is read instead of mapped
+    long page = 4096;
+#ifdef YAAP_HAS_MMAP
+    page = ::sysconf( _SC_PAGESIZE );
+#endif
+    {
+        std::string content = "-- ";
+        content.append( static_cast<std::size_t>( page ) - content.size() - 4, ' ' );
+        content += "last";
+        TemporaryFile file( "page.rsp", content );
+        CommandLine line;
+        line << file.Argument();
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        CHECK( parser.ExpandResponseFiles() );
+        std::vector<std::string> operands = Operands( parser );
+        CHECK( operands.size() == 1 && operands[0] == "last" );
+    }
+    {
+        // and a file one byte short of it is mapped
+        std::string content( static_cast<std::size_t>( page ) - 3 - 5, ' ' );
+        std::vector<std::string> operands = Expand( "short.rsp", content + "last" );
+        CHECK( operands.size() == 1 && operands[0] == "last" );
+    }
+
+    // nested files are expanded, down to 16 levels: a file including itself
+    // stops there and its last '@file' is kept as is
+    {
+        TemporaryFile inner( "inner.rsp", "c d" );
+        TemporaryFile outer( "outer.rsp", "a " + inner.Argument() + " b" );
+        std::vector<std::string> args = Expand( "nested.rsp", outer.Argument() );
+        CHECK( args.size() == 4 && args[0] == "a" && args[1] == "c" && args[2] == "d" && args[3] == "b" );
+    }
+    {
+        TemporaryFile self( "self.rsp", "x @yaap_check_self.rsp" );
+        CommandLine line;
+        line << "--" << self.Argument();
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        CHECK( parser.ExpandResponseFiles() );
+        std::vector<std::string> args = Operands( parser );
+        CHECK( args.size() == 17 );
+        for( std::size_t k = 0; k + 1 < args.size(); k++ )
+            CHECK( args[k] == "x" );
+        CHECK( !args.empty() && args.back() == self.Argument() );
+    }
+
+    // an unreadable file is kept as is and reported with its index
+    {
+        TemporaryFile file( "readable.rsp", "b" );
+        CommandLine line;
+        line << "--" << "a" << "@yaap_check_missing.rsp" << file.Argument() << "@";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        CHECK( !parser.ExpandResponseFiles() );
+        std::vector<std::string> args = Operands( parser );
+        CHECK( args.size() == 4 && args[0] == "a" && args[1] == "@yaap_check_missing.rsp"
+               && args[2] == "b" && args[3] == "@" );
+        CHECK( parser.Errors().size() == 1 );
+        if( parser.Errors().size() == 1 )
+        {
+            CHECK( parser.Errors()[0].code == yaap::Error::UnreadableFile );
+            CHECK( parser.Errors()[0].argIndex == 3 );
+        }
+        CHECK( !parser.IsCommandLineValid() );
+    }
+
+    // argv[0] is never a response file
+    {
+        char program[] = "@yaap_check_missing.rsp";
+        char* argv[] = { program, NULL };
+        yaap::Parser parser( 1, argv );
+        CHECK( parser.ExpandResponseFiles() );
+    }
+}
+
+#ifdef YAAP_HAS_THREADS
+//! Wait until the reads started by parser.Prefetch() are over
+static bool WaitPrefetch( yaap::Parser& parser )
+{
+    for( int k = 0; k < 5000 && !parser.IsPrefetched(); k++ )
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    return( parser.IsPrefetched() );
+}
+
+static void TestPrefetch( )
+{
+    // prefetched response files are expanded as read ones, the files they
+    // name being read then
+    {
+        TemporaryFile inner( "prefetch_inner.rsp", "c" );
+        TemporaryFile first( "prefetch_first.rsp", "a " + inner.Argument() );
+        TemporaryFile second( "prefetch_second.rsp", "'b b'" );
+        CommandLine line;
+        line << "--" << first.Argument() << second.Argument() << first.Argument();
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.Prefetch();
+        parser.Prefetch(); // the pending files are not read twice
+        CHECK( WaitPrefetch( parser ) );
+        CHECK( parser.ExpandResponseFiles() );
+        std::vector<std::string> args = Operands( parser );
+        const char* expected[] = { "a", "c", "b b", "a", "c" };
+        CHECK( args == std::vector<std::string>( expected, expected + 5 ) );
+        CHECK( parser.IsPrefetched() && parser.IsCommandLineValid() );
+    }
+    // prefetched but never expanded: the destructor waits for the reads
+    {
+        TemporaryFile file( "prefetch_unused.rsp", "a b c" );
+        CommandLine line;
+        line << file.Argument() << file.Argument();
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.Prefetch();
+        CHECK( parser.IsCommandLineValid() );
+    }
+    // a missing file is reported as if read by ExpandResponseFiles()
+    {
+        TemporaryFile file( "prefetch_present.rsp", "b" );
+        CommandLine line;
+        line << "--" << "@yaap_check_prefetch_missing.rsp" << file.Argument();
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.Prefetch();
+        CHECK( !parser.ExpandResponseFiles() );
+        std::vector<std::string> args = Operands( parser );
+        CHECK( args.size() == 2 && args[0] == "@yaap_check_prefetch_missing.rsp" && args[1] == "b" );
+        CHECK( parser.Errors().size() == 1 && parser.Errors()[0].code == yaap::Error::UnreadableFile
+               && parser.Errors()[0].argIndex == 2 );
+    }
+    // the configuration file is taken by SetConfigFile() with the same paths
+    {
+        TemporaryFile source( "prefetch.ini", "jobs = 5\n" );
+        CommandLine line;
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.Prefetch( source.Path() );
+        CHECK( WaitPrefetch( parser ) );
+        source.Write( "jobs = 6\n" ); // the prefetched content is kept
+        CHECK( parser.SetConfigFile( source.Path() ) );
+        CHECK( parser.AddOptionArg<int>( 'j', "jobs", "Jobs", 1 )->GetValue() == 5 );
+    }
+    {
+        // called twice, read by the second call
+        TemporaryFile source( "prefetch_twice.ini", "jobs = 5\n" );
+        TemporaryFile other( "prefetch_other.ini", "jobs = 7\n" );
+        CommandLine line;
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.Prefetch( source.Path() );
+        parser.Prefetch( other.Path() );
+        CHECK( parser.SetConfigFile( other.Path() ) );
+        CHECK( parser.AddOptionArg<int>( 'j', "jobs", "Jobs", 1 )->GetValue() == 7 );
+    }
+    {
+        // another path is read by SetConfigFile()
+        TemporaryFile source( "prefetch_unused.ini", "jobs = 5\n" );
+        TemporaryFile other( "prefetch_used.ini", "jobs = 7\n" );
+        CommandLine line;
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.Prefetch( source.Path() );
+        CHECK( parser.SetConfigFile( other.Path() ) );
+        CHECK( parser.AddOptionArg<int>( 'j', "jobs", "Jobs", 1 )->GetValue() == 7 );
+        CHECK( WaitPrefetch( parser ) );
+    }
+    {
+        CommandLine line;
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.Prefetch( "yaap_check_prefetch_missing.ini" );
+        CHECK( !parser.SetConfigFile( "yaap_check_prefetch_missing.ini" ) );
+    }
+}
+#endif
+
+//! Add the options of the "build" subcommand, see TestConfiguration()
+struct BuildOptions {
+    yaap::OptionArg<int>** jobs;
+
+    void operator()( yaap::Parser& parser ) const {
+        *this->jobs = parser.AddOptionArg<int>( 'j', "jobs", "Parallel jobs", 1 );
+    };
+};
+
+//! Value of --jobs taken from the configuration file source
+static int ConfiguredJobs( const TemporaryFile& source, const TemporaryFile& snapshot )
+{
+    CommandLine line;
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    CHECK( parser.SetConfigFile( source.Path(), snapshot.Path() ) );
+    return( parser.AddOptionArg<int>( 'j', "jobs", "Parallel jobs", 1 )->GetValue() );
+}
+
+static void TestConfiguration( )
+{
+    TemporaryFile ini( "tool.ini", "# comment\n; comment\njobs = 1\nname = 'from file'\nlevel: 3\n"
+                                   "verbose = yes\n\n[build]\njobs = 2\n" );
+    // the command line first, then the environment, then the file
+#ifdef YAAP_HAS_MMAP
+    ::setenv( "YAAPCHECK_NAME", "from environment", 1 );
+    ::setenv( "YAAPCHECK_LEVEL", "5", 1 );
+    ::setenv( "YAAPCHECK_JOBS", "7", 1 );
+    {
+        CommandLine line;
+        line << "--jobs" << "9";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.UseEnvironment( "YAAPCHECK_" );
+        CHECK( parser.SetConfigFile( ini.Path() ) );
+        yaap::OptionArg<int>* jobs = parser.AddOptionArg<int>( 'j', "jobs", "Parallel jobs", 1 );
+        yaap::OptionArg<std::string>* name = parser.AddOptionArg<std::string>( 'n', "name", "Name", 1 );
+        yaap::OptionArg<int>* level = parser.AddOptionArg<int>( 'l', "level", "Level", 1 );
+        yaap::Option* verbose = parser.AddOption( 'v', "verbose", "Verbose" );
+        yaap::Option* quiet = parser.AddOption( 'q', "quiet", "Quiet" );
+        CHECK( jobs->GetValue() == 9 );
+        CHECK( name->GetValue() == "from environment" );
+        CHECK( level->GetValue() == 5 );
+        CHECK( verbose->Exists() && !quiet->Exists() );
+        CHECK( parser.IsCommandLineValid() );
+    }
+    ::unsetenv( "YAAPCHECK_NAME" );
+    ::unsetenv( "YAAPCHECK_LEVEL" );
+    ::unsetenv( "YAAPCHECK_JOBS" );
+#endif
+    {
+        CommandLine line;
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.UseEnvironment( "YAAPCHECK_" );
+        CHECK( parser.SetConfigFile( ini.Path() ) );
+        yaap::OptionArg<std::string>* name = parser.AddOptionArg<std::string>( 'n', "name", "Name", 1 );
+        yaap::OptionArg<int>* level = parser.AddOptionArg<int>( 'l', "level", "Level", 1 );
+        yaap::OptionArg<int>* jobs = parser.AddOptionArg<int>( 'j', "jobs", "Parallel jobs", 1 );
+        CHECK( name->GetValue() == "from file" );
+        CHECK( level->GetValue() == 3 );
+        CHECK( jobs->GetValue() == 1 ); // not the [build] section
+    }
+
+    // a "[name]" section applies to the subcommand name, before the top lines
+    {
+        CommandLine line;
+        line << "build";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        CHECK( parser.SetConfigFile( ini.Path() ) );
+        yaap::OptionArg<int>* jobs = NULL;
+        BuildOptions options = { &jobs };
+        CHECK( parser.AddSubcommand( "build", options ) );
+        CHECK( jobs != NULL && jobs->GetValue() == 2 );
+    }
+    {
+        TemporaryFile plain( "plain.ini", "jobs = 1\n[test]\njobs = 3\n" );
+        CommandLine line;
+        line << "build";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        CHECK( parser.SetConfigFile( plain.Path() ) );
+        yaap::OptionArg<int>* jobs = NULL;
+        BuildOptions options = { &jobs };
+        CHECK( parser.AddSubcommand( "build", options ) );
+        CHECK( jobs != NULL && jobs->GetValue() == 1 );
+    }
+    {
+        CommandLine line;
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        CHECK( !parser.SetConfigFile( "yaap_check_missing.ini" ) );
+    }
+
+#ifdef YAAP_HAS_MMAP
+    // the snapshot of a file older than it is loaded as is
+    TemporaryFile source( "snapshot.ini", "jobs = 4\n" );
+    TemporaryFile snapshot( "snapshot.cache", "" );
+    struct utimbuf past;
+    past.actime = past.modtime = std::time( NULL ) - 100;
+    CHECK( ::utime( source.Path().c_str(), &past ) == 0 );
+    CHECK( ConfiguredJobs( source, snapshot ) == 4 );
+    std::string cache = snapshot.Read();
+    std::size_t value = cache.find( std::string( "jobs\0" "4", 6 ) );
+    CHECK( value != std::string::npos );
+    if( value != std::string::npos )
+    {
+        cache[value + 5] = '5'; // tell the snapshot from the file
+        snapshot.Write( cache );
+        CHECK( ConfiguredJobs( source, snapshot ) == 5 );
+    }
+    // an edit keeping the size and the modification time is seen
+    source.Write( "jobs = 8\n" );
+    CHECK( ::utime( source.Path().c_str(), &past ) == 0 );
+    CHECK( ConfiguredJobs( source, snapshot ) == 8 );
+    // and so is an edit of the same size right after the snapshot
+    source.Write( "jobs = 6\n" );
+    CHECK( ConfiguredJobs( source, snapshot ) == 6 );
+    source.Write( "jobs = 3\n" );
+    CHECK( ConfiguredJobs( source, snapshot ) == 3 );
+#endif
+}
+
+//! Codes of the errors of parser, in order
+static std::vector<yaap::Error::Code> ErrorCodes( const yaap::ErrorBuffer& errors )
+{
+    std::vector<yaap::Error::Code> codes;
+    for( const yaap::Error* it = errors.begin(); it != errors.end(); ++it )
+        codes.push_back( it->code );
+    return( codes );
+}
+
+static void TestDuplicateOptions( )
+{
+    CommandLine line;
+    line << "-x" << "--beta" << "--other";
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    yaap::Option* alpha = parser.AddOption( 'a', "alpha", "Alpha" );
+    yaap::Option* twin = parser.AddOption( 'x', "alpha", "Alpha again" );
+    yaap::Option* xray = parser.AddOption( 'x', "xray", "Xray" );
+    yaap::Option* beta = parser.AddOption( 'a', "beta", "Beta" );
+    yaap::Option* wide = parser.AddOption( 'W', "wide", "Reserved" );
+    yaap::Option* dash = parser.AddOption( '-', "dash", "Reserved" );
+    yaap::Option* dryRun = parser.AddOption( '\0', "dry-run", "Dry run" );
+    yaap::Option* dryTwin = parser.AddOption( '\0', "dry-run", "Dry run again" );
+    yaap::Option* other = parser.AddOption( '\0', "other", "Other" );
+    // a rejected option registers neither its flag nor its long name
+    CHECK( parser.GetOption( 'a' ) == alpha && parser.GetOption( "alpha" ) == alpha );
+    CHECK( parser.GetOption( 'x' ) == xray && parser.GetOption( "xray" ) == xray );
+    CHECK( parser.GetOption( "beta" ) == NULL && parser.GetOption( "wide" ) == NULL && parser.GetOption( "dash" ) == NULL );
+    CHECK( parser.GetOption( "dry-run" ) == dryRun && parser.GetOption( "other" ) == other );
+    CHECK( parser.GetOption( 'W' ) == NULL && parser.GetOption( '-' ) == NULL );
+    CHECK( xray->Exists() && !twin->Exists() && !alpha->Exists() && other->Exists() );
+    CHECK( twin->ErrorFlag() && beta->ErrorFlag() && wide->ErrorFlag() && dash->ErrorFlag() && dryTwin->ErrorFlag() );
+    CHECK( !alpha->ErrorFlag() && !xray->ErrorFlag() && !dryRun->ErrorFlag() && !other->ErrorFlag() );
+    CHECK( !parser.IsCommandLineValid() );
+    std::vector<yaap::Error::Code> codes = ErrorCodes( parser.Errors() );
+    yaap::Error::Code expected[] = { yaap::Error::DuplicateOption, yaap::Error::DuplicateOption, yaap::Error::ReservedFlag,
+                                     yaap::Error::ReservedFlag, yaap::Error::DuplicateOption };
+    CHECK( codes == std::vector<yaap::Error::Code>( expected, expected + 5 ) );
+    CHECK( codes.size() == 5 && parser.Errors()[0].option == twin && parser.Errors()[1].option == beta
+           && parser.Errors()[2].option == wide && parser.Errors()[4].option == dryTwin );
+    // the same after an edition of the command line
+    parser.Update( 1, "-a" );
+    CHECK( alpha->Exists() && !xray->Exists() && !twin->Exists() && !beta->Exists() );
+    CHECK( ErrorCodes( parser.Errors() ) == std::vector<yaap::Error::Code>( expected, expected + 5 ) );
+
+    yaap::Layout layout;
+    CHECK( layout.AddOption( 'a', "alpha", "Alpha" ) == 0 );
+    layout.AddOption( 'x', "alpha", "Alpha again" );
+    CHECK( layout.AddOption( 'x', "xray", "Xray" ) == 2 );
+    layout.AddOption( 'a', "beta", "Beta" );
+    layout.AddOption( 'W', "wide", "Reserved" );
+    CHECK( !layout.IsValid() );
+    CHECK( layout.Find( 'a' ) == 0 && layout.Find( "alpha" ) == 0 );
+    CHECK( layout.Find( 'x' ) == 2 && layout.Find( "xray" ) == 2 );
+    CHECK( layout.Find( "beta" ) == yaap::OptionIndex::npos && layout.Find( 'W' ) == yaap::OptionIndex::npos );
+    yaap::ParseResult result;
+    CHECK( !layout.Parse( line.Argc(), line.Argv(), result ) );
+    CHECK( result.Exists( 2 ) && !result.Exists( 1 ) );
+    yaap::Error::Code layoutErrors[] = { yaap::Error::DuplicateOption, yaap::Error::DuplicateOption, yaap::Error::ReservedFlag };
+    std::vector<yaap::Error::Code> found = ErrorCodes( result.Errors() );
+    found.resize( std::min<std::size_t>( found.size(), 3 ) );
+    CHECK( found == std::vector<yaap::Error::Code>( layoutErrors, layoutErrors + 3 ) );
+}
+
+//! True if usage shows --dry-run by its long name only
+static bool ShowsLongNameOnly( const std::string& usage )
+{
+    return( usage.find( '\0' ) == std::string::npos && usage.find( " [--dry-run]" ) != std::string::npos
+            && usage.find( "\t--dry-run : " ) != std::string::npos && usage.find( "[-j/--jobs" ) != std::string::npos );
+}
+
+#ifdef YAAP_HAS_MMAP
+//! Completion request of parser
+struct ParserCompletion {
+    explicit ParserCompletion( yaap::Parser& parser ) : parser( parser ) {};
+
+    bool operator()( ) {
+        return( this->parser.Complete() );
+    };
+
+    yaap::Parser& parser;
+};
+
+#ifdef YAAP_HAS_CXX17
+//! Completion request of FlaglessSchema, for the command line
+struct SchemaCompletion {
+    explicit SchemaCompletion( CommandLine& line ) : line( line ) {};
+
+    bool operator()( ) {
+        return( FlaglessSchema::Complete( this->line.Argc(), this->line.Argv() ) );
+    };
+
+    CommandLine& line;
+};
+#endif
+
+//! Words printed by complete(), the standard output being redirected
+template<typename Completion>
+static std::string CompletionWords( Completion complete )
+{
+    TemporaryFile output( "complete", "" );
+    std::fflush( stdout );
+    const int saved = ::dup( 1 );
+    if( std::freopen( output.Path().c_str(), "wb", stdout ) == NULL )
+        return( "" );
+    const bool completed = complete();
+    std::fflush( stdout );
+    ::dup2( saved, 1 );
+    ::close( saved );
+    CHECK( completed );
+    return( output.Read() );
+}
+#endif
+
+static void TestFlaglessOptions( )
+{
+    CommandLine line;
+    line << "--dry-run" << "-j" << "4";
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    yaap::Option* dryRun = parser.AddOption( '\0', "dry-run", "Show what would be done" );
+    yaap::OptionArg<int>* jobs = parser.AddOptionArg<int>( 'j', "jobs", "Number of jobs", 1 );
+    CHECK( parser.IsCommandLineValid() );
+    CHECK( dryRun->Exists() && jobs->GetArgument( 0 ) == 4 );
+    CHECK( ShowsLongNameOnly( parser.GetUsage() ) );
+
+    yaap::Layout layout;
+    layout.AddOption( '\0', "dry-run", "Show what would be done" );
+    layout.AddOptionArg<int>( 'j', "jobs", "Number of jobs", 1 );
+    CHECK( layout.IsValid() );
+    std::string text;
+    layout.GetUsage( "checkyaap", NULL, text );
+    CHECK( ShowsLongNameOnly( text ) );
+
+#ifdef YAAP_HAS_MMAP
+    CommandLine request;
+    request << "--yaap-complete" << "-";
+    yaap::Parser completing( request.Argc(), request.Argv() );
+    completing.AddOption( '\0', "dry-run", "Show what would be done" );
+    completing.AddOptionArg<int>( 'j', "jobs", "Number of jobs", 1 );
+    const std::string words = CompletionWords( ParserCompletion( completing ) );
+    CHECK( words.find( '\0' ) == std::string::npos );
+    CHECK( words.find( "--dry-run\n" ) != std::string::npos && words.find( "-j\n" ) != std::string::npos );
+    CHECK( words.find( "-\n" ) == std::string::npos );
+#endif
+
+#ifdef YAAP_HAS_CXX17
+    FlaglessSchema::Result result;
+    CHECK( FlaglessSchema::Parse( line.Argc(), line.Argv(), result ) );
+    CHECK( result.Get<DryRun>() && result.Get<Jobs>() == 4 );
+    FlaglessSchema::GetUsage( "checkyaap", "", NULL, text );
+    CHECK( ShowsLongNameOnly( text ) && text.find( " [-q]" ) != std::string::npos );
+#ifdef YAAP_HAS_MMAP
+    // neither a "-\0" for --dry-run nor a bare "--" for -q
+    const char* prefixes[] = { "", "-", "--", "--j", "-j", "--x" };
+    const char* candidates[] = { "-j\n-q\n--dry-run\n--jobs\n", "-j\n-q\n--dry-run\n--jobs\n", "--dry-run\n--jobs\n",
+                               "--jobs\n", "", "" };
+    for( std::size_t k = 0; k < sizeof( prefixes ) / sizeof( prefixes[0] ); k++ )
+    {
+        CommandLine schemaRequest;
+        schemaRequest << "--yaap-complete" << "-j" << "4" << prefixes[k];
+        CHECK( CompletionWords( SchemaCompletion( schemaRequest ) ) == candidates[k] );
+    }
+#endif
+#endif
+}
+
+//! Number of errors of parser with the given code
+static unsigned int CountErrors( const yaap::Parser& parser, yaap::Error::Code code )
+{
+    unsigned int n = 0;
+    const yaap::ErrorBuffer& errors = parser.Errors();
+    for( const yaap::Error* it = errors.begin(); it != errors.end(); ++it )
+        if( it->code == code )
+            n++;
+    return( n );
+}
+
+//! Errors found by Validate() on a command line of the options below
+static std::vector<yaap::Error::Code> ConstraintErrors( const std::string& args )
+{
+    CommandLine line;
+    for( std::size_t first = 0, last; first < args.size(); first = last + 1 )
+    {
+        last = args.find( ' ', first );
+        if( last == std::string::npos )
+            last = args.size();
+        line << args.substr( first, last - first );
+    }
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    yaap::Option* archive = parser.AddOption( 'a', "archive", "Archive" );
+    yaap::Option* compress = parser.AddOption( 'c', "compress", "Compress the archive" );
+    yaap::Option* tar = parser.AddOption( 't', "tar", "Tar format" );
+    yaap::Option* zip = parser.AddOption( 'z', "zip", "Zip format" );
+    yaap::Option* piped = parser.AddOption( 'p', "stdout", "Write on the standard output" );
+    yaap::Option* output = parser.AddOptionArg<std::string>( 'o', "output", "Output file", 1 );
+    yaap::OptionArg<int>* jobs = parser.AddOptionArg<int>( 'j', "jobs", "Number of jobs", 1 );
+    yaap::OptionArg<std::string>* mode = parser.AddOptionArg<std::string>( 'm', "mode", "Mode", 1 );
+    parser.Requires( compress, archive );
+    parser.Excludes( piped, output );
+    std::vector<yaap::Option*> formats;
+    formats.push_back( tar );
+    formats.push_back( zip );
+    parser.AtLeastOneOf( formats );
+    parser.AtMostOneOf( formats );
+    jobs->SetRange( 1, 8 );
+    std::vector<std::string> modes;
+    modes.push_back( "fast" );
+    modes.push_back( "best" );
+    mode->SetChoices( modes );
+    std::vector<yaap::Error::Code> codes;
+    CHECK( parser.Validate() == parser.IsCommandLineValid() );
+    const yaap::ErrorBuffer& errors = parser.Errors();
+    for( const yaap::Error* it = errors.begin(); it != errors.end(); ++it )
+        codes.push_back( it->code );
+    return( codes );
+}
+
+//! The only error of a command line of ConstraintErrors()
+static bool OnlyError( const std::string& args, yaap::Error::Code code )
+{
+    std::vector<yaap::Error::Code> codes = ConstraintErrors( args );
+    return( codes.size() == 1 && codes[0] == code );
+}
+
+static void TestConstraints( )
+{
+    CHECK( ConstraintErrors( "-t" ).empty() );
+    CHECK( ConstraintErrors( "-a -c -z -p -j 1 -m fast" ).empty() );
+    CHECK( ConstraintErrors( "-c -a -t -o out -j 8 -m best" ).empty() );
+    // Requires(), Excludes()
+    CHECK( OnlyError( "-c -t", yaap::Error::MissingDependency ) );
+    CHECK( OnlyError( "-t -p -o out", yaap::Error::Conflict ) );
+    CHECK( OnlyError( "-t -o out -p", yaap::Error::Conflict ) );
+    // AtLeastOneOf(), AtMostOneOf()
+    CHECK( OnlyError( "-a", yaap::Error::MissingAlternative ) );
+    CHECK( OnlyError( "-t -z", yaap::Error::Conflict ) );
+    // SetRange(), SetChoices()
+    CHECK( OnlyError( "-t -j 0", yaap::Error::OutOfRange ) );
+    CHECK( OnlyError( "-t -j 9", yaap::Error::OutOfRange ) );
+    CHECK( OnlyError( "-t -m quick", yaap::Error::InvalidChoice ) );
+    CHECK( OnlyError( "-t -m Fast", yaap::Error::InvalidChoice ) );
+    CHECK( ConstraintErrors( "-c -j 9 -m quick -t -z" ).size() == 4 );
+
+    // the subject of a relation carries the error
+    CommandLine line;
+    line << "-c" << "-j" << "12";
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    yaap::Option* archive = parser.AddOption( 'a', "archive", "Archive" );
+    yaap::Option* compress = parser.AddOption( 'c', "compress", "Compress the archive" );
+    yaap::OptionArg<int>* jobs = parser.AddOptionArg<int>( 'j', "jobs", "Number of jobs", 1 );
+    parser.Requires( compress, archive );
+    jobs->SetRange( 1, 8 );
+    CHECK( parser.IsCommandLineValid() );
+    CHECK( !parser.Validate() );
+    CHECK( compress->ErrorFlag() && !archive->ErrorFlag() && jobs->ErrorFlag() );
+    CHECK( parser.Errors().size() == 2 && parser.Errors()[0].option == jobs && parser.Errors()[1].option == compress );
+    // checking again, after another option, does not repeat the errors
+    parser.AddOption( 'v', "verbose", "Verbose output" );
+    CHECK( !parser.Validate() );
+    CHECK( !parser.Validate() );
+    CHECK( CountErrors( parser, yaap::Error::OutOfRange ) == 1 );
+    CHECK( CountErrors( parser, yaap::Error::MissingDependency ) == 1 );
+    CHECK( parser.Errors().size() == 2 );
+}
+
+//! UTF-8 encoding of the code units, one code point at a time: the
+//! reference of detail::EncodeUtf8(), which narrows ASCII runs in bulk
+static std::string ReferenceUtf8( const std::vector<unsigned long>& units, bool utf16 )
+{
+    std::string out;
+    for( std::size_t k = 0; k < units.size(); k++ )
+    {
+        unsigned long c = units[k];
+        if( utf16 && c >= 0xD800 && c < 0xDC00 && k + 1 < units.size() && units[k + 1] >= 0xDC00 && units[k + 1] < 0xE000 )
+            c = 0x10000 + ( ( c - 0xD800 ) << 10 ) + ( units[++k] - 0xDC00 );
+        else if( ( c >= 0xD800 && c < 0xE000 ) || c > 0x10FFFF )
+            c = 0xFFFD;
+        if( c < 0x80 )
+            out += static_cast<char>( c );
+        else if( c < 0x800 )
+            ( out += static_cast<char>( 0xC0 | ( c >> 6 ) ) ) += static_cast<char>( 0x80 | ( c & 0x3F ) );
+        else if( c < 0x10000 )
+            ( ( out += static_cast<char>( 0xE0 | ( c >> 12 ) ) ) += static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3F ) ) )
+                += static_cast<char>( 0x80 | ( c & 0x3F ) );
+        else
+            ( ( ( out += static_cast<char>( 0xF0 | ( c >> 18 ) ) ) += static_cast<char>( 0x80 | ( ( c >> 12 ) & 0x3F ) ) )
+                += static_cast<char>( 0x80 | ( ( c >> 6 ) & 0x3F ) ) ) += static_cast<char>( 0x80 | ( c & 0x3F ) );
+    }
+    return( out );
+}
+
+//! True if detail::EncodeUtf8() on units of type Unit matches ReferenceUtf8()
+template<typename Unit>
+static bool EncodesLikeReference( const std::vector<unsigned long>& units )
+{
+    std::vector<Unit> wide( units.size() + 1, 0 );
+    for( std::size_t k = 0; k < units.size(); k++ )
+        wide[k] = static_cast<Unit>( units[k] );
+    const Unit* first = &wide[0];
+    const Unit* last = first + units.size();
+    std::size_t length = yaap::detail::Utf8Length( first, last );
+    std::string out( length + 1, '#' );
+    char* end = yaap::detail::EncodeUtf8( first, last, &out[0] );
+    return( end == &out[0] + length && out[length] == '#'
+            && out.substr( 0, length ) == ReferenceUtf8( units, sizeof( Unit ) == 2 ) );
+}
+
+//! Wide operands, parsed as a wmain() command line, then read back in UTF-8
+static std::vector<std::string> WideOperands( const std::vector<std::wstring>& args )
+{
+    std::vector<std::wstring> strings( 1, L"checkyaap" );
+    strings.push_back( L"--" );
+    strings.insert( strings.end(), args.begin(), args.end() );
+    std::vector<wchar_t*> argv;
+    for( std::size_t k = 0; k < strings.size(); k++ )
+        argv.push_back( &strings[k][0] );
+    argv.push_back( NULL );
+    yaap::Parser parser( static_cast<int>( strings.size() ), &argv[0] );
+    return( Operands( parser ) );
+}
+
+static void TestWideCommandLines( )
+{
+    // non-ASCII units inside ASCII runs of 0 to 20 units, around the 4 and
+    // 8 units of the bulk narrowing
+    const unsigned long wide16[] = { 0x80, 0xE9, 0xFF, 0x100, 0x7FF, 0x800, 0x20AC, 0x8000, 0xFFFD, 0xFFFF,
+                                     0xD800, 0xDBFF, 0xDC00, 0xDFFF };
+    const unsigned long wide32[] = { 0x1F600, 0x10000, 0x10FFFF, 0x110000, 0x80000000UL, 0xFFFFFFFFUL };
+    unsigned int mismatches16 = 0, mismatches32 = 0;
+    for( std::size_t size = 0; size <= 20; size++ )
+    {
+        std::vector<unsigned long> units;
+        for( std::size_t k = 0; k < size; k++ )
+            units.push_back( 'a' + k % 26 );
+        mismatches16 += !EncodesLikeReference<unsigned short>( units );
+        mismatches32 += !EncodesLikeReference<unsigned int>( units );
+        for( std::size_t pos = 0; pos <= size; pos++ )
+        {
+            std::vector<unsigned long> mixed( units );
+            mixed.insert( mixed.begin() + pos, 0 );
+            for( std::size_t c = 0; c < sizeof( wide16 ) / sizeof( wide16[0] ); c++ )
+            {
+                mixed[pos] = wide16[c];
+                mismatches16 += !EncodesLikeReference<unsigned short>( mixed );
+                mismatches32 += !EncodesLikeReference<unsigned int>( mixed );
+            }
+            for( std::size_t c = 0; c < sizeof( wide32 ) / sizeof( wide32[0] ); c++ )
+            {
+                mixed[pos] = wide32[c];
+                mismatches32 += !EncodesLikeReference<unsigned int>( mixed );
+            }
+            // a surrogate pair, cut by the end of the string when pos == size
+            mixed[pos] = 0xD83D;
+            mixed.insert( mixed.begin() + pos + 1, 0xDE00 );
+            mismatches16 += !EncodesLikeReference<unsigned short>( mixed );
+            mixed.pop_back();
+            mismatches16 += !EncodesLikeReference<unsigned short>( mixed );
+        }
+    }
+    CHECK( mismatches16 == 0 );
+    CHECK( mismatches32 == 0 );
+
+    std::vector<unsigned long> units;
+    units.push_back( 0xD83D );
+    units.push_back( 0xDE00 );
+    CHECK( ReferenceUtf8( units, true ) == "\xF0\x9F\x98\x80" );
+    units[0] = 0x20AC;
+    units[1] = 0xD800;
+    CHECK( ReferenceUtf8( units, true ) == "\xE2\x82\xAC\xEF\xBF\xBD" );
+    units[0] = 0xE9;
+    units[1] = 0x110000;
+    CHECK( ReferenceUtf8( units, false ) == "\xC3\xA9\xEF\xBF\xBD" );
+
+    // a wide parser reads what a narrow one reads of the UTF-8 arguments
+    std::vector<std::wstring> args;
+    args.push_back( L"" );
+    args.push_back( L"abcdefghijklmnopq" );
+    args.push_back( std::wstring( 1, static_cast<wchar_t>( 0xE9 ) ) + L"t" + static_cast<wchar_t>( 0xE9 ) );
+    args.push_back( L"nine char" + std::wstring( 1, static_cast<wchar_t>( 0x20AC ) ) + L"abcdefgh" );
+    if( sizeof( wchar_t ) == 2 )
+    {
+        args.push_back( L"smile " + std::wstring( 1, static_cast<wchar_t>( 0xD83D ) ) + static_cast<wchar_t>( 0xDE00 ) );
+        args.push_back( L"lone " + std::wstring( 1, static_cast<wchar_t>( 0xD83D ) ) + L"surrogate" );
+    }
+    else
+    {
+        args.push_back( L"smile " + std::wstring( 1, static_cast<wchar_t>( 0x1F600 ) ) );
+        args.push_back( L"lone " + std::wstring( 1, static_cast<wchar_t>( 0xD83D ) ) + L"surrogate" );
+    }
+    std::vector<std::string> expected;
+    expected.push_back( "" );
+    expected.push_back( "abcdefghijklmnopq" );
+    expected.push_back( "\xC3\xA9t\xC3\xA9" );
+    expected.push_back( "nine char\xE2\x82\xAC" "abcdefgh" );
+    expected.push_back( "smile \xF0\x9F\x98\x80" );
+    expected.push_back( "lone \xEF\xBF\xBD" "surrogate" );
+    CHECK( WideOperands( args ) == expected );
+
+    CommandLine line;
+    line << "--";
+    for( std::size_t k = 0; k < expected.size(); k++ )
+        line << expected[k];
+    yaap::Parser narrow( line.Argc(), line.Argv() );
+    CHECK( Operands( narrow ) == expected );
+}
+
+//! Offset at which yaap::Converter<T> stops in text, its size on success
+template<typename T>
+static std::size_t Stop( const std::string& text, T& value )
+{
+    const char* first = text.data();
+    return( static_cast<std::size_t>( yaap::Converter<T>::Convert( first, first + text.size(), value ) - first ) );
+}
+
+//! True if text converts as a whole into value
+template<typename T>
+static bool Converts( const std::string& text, T& value )
+{
+    return( Stop( text, value ) == text.size() );
+}
+
+static void TestConverters( )
+{
+#if __cplusplus >= 201103L
+    // durations with integral ticks: whole numbers of ticks only
+    std::chrono::milliseconds ms( 7 );
+    CHECK( Converts( "500ms", ms ) && ms.count() == 500 );
+    CHECK( Converts( "2s", ms ) && ms.count() == 2000 );
+    CHECK( Converts( "3min", ms ) && ms.count() == 180000 );
+    CHECK( Converts( "1d", ms ) && ms.count() == 86400000 );
+    CHECK( Converts( "2000us", ms ) && ms.count() == 2 );
+    CHECK( Converts( "0ns", ms ) && ms.count() == 0 );
+    ms = std::chrono::milliseconds( 7 );
+    CHECK( Stop( "1us", ms ) == 1 && ms.count() == 7 );
+    CHECK( Stop( "1500us", ms ) == 4 );
+    CHECK( Stop( "500", ms ) == 0 ); // no unit
+    CHECK( Stop( "ms", ms ) == 0 );
+    CHECK( Stop( "-5ms", ms ) == 0 );
+    CHECK( Stop( "5sec", ms ) == 1 );
+    CHECK( Stop( "5 ms", ms ) == 1 );
+    CHECK( Stop( "1.5ms", ms ) == 1 );
+    CHECK( Stop( "99999999999999999999ms", ms ) == 19 ); // too many digits
+    CHECK( Stop( "18446744073709551615s", ms ) == 20 ); // too many ticks
+    CHECK( Stop( "9223372036854775808ms", ms ) == 19 ); // above the Rep
+    std::chrono::duration<short, std::milli> shortMs;
+    CHECK( Converts( "32s", shortMs ) && shortMs.count() == 32000 );
+    CHECK( Stop( "33s", shortMs ) == 2 );
+    std::chrono::hours hours;
+    CHECK( Converts( "120min", hours ) && hours.count() == 2 );
+    CHECK( Stop( "90min", hours ) == 2 );
+    CHECK( Stop( "1s", hours ) == 1 );
+    std::chrono::nanoseconds ns;
+    CHECK( Converts( "106751d", ns ) && ns.count() == 106751LL * 86400 * 1000000000 );
+    CHECK( Stop( "106752d", ns ) == 6 );
+    // durations with floating point ticks take fractions
+    std::chrono::duration<double, std::milli> real;
+    CHECK( Converts( "1.5ms", real ) && real.count() == 1.5 );
+    CHECK( Converts( "1.5s", real ) && real.count() == 1500.0 );
+    CHECK( Converts( ".25s", real ) && real.count() == 250.0 );
+    CHECK( Converts( "500us", real ) && real.count() == 0.5 );
+    CHECK( Stop( "1.5", real ) == 0 );
+    CHECK( Stop( "1.5m", real ) == 3 );
+    CHECK( Stop( "-1ms", real ) == 0 );
+
+    // byte sizes: powers of 1000 for kB..EB, of 1024 for K..E and KiB..EiB
+    yaap::ByteSize size;
+    CHECK( Converts( "1500", size ) && size.bytes == 1500 );
+    CHECK( Converts( "12B", size ) && size.bytes == 12 );
+    CHECK( Converts( "4GiB", size ) && size.bytes == 4ULL << 30 );
+    CHECK( Converts( "4G", size ) && size.bytes == 4ULL << 30 );
+    CHECK( Converts( "4GB", size ) && size.bytes == 4000000000ULL );
+    CHECK( Converts( "512k", size ) && size.bytes == 512 * 1024 );
+    CHECK( Converts( "512kB", size ) && size.bytes == 512000 );
+    CHECK( Converts( "15EiB", size ) && size.bytes == 15ULL << 60 );
+    CHECK( Converts( "18446744073709551615", size ) && size.bytes == 18446744073709551615ULL );
+    size = yaap::ByteSize( 3 );
+    CHECK( Stop( "16EiB", size ) == 2 && size.bytes == 3 ); // 2^64
+    CHECK( Stop( "19EB", size ) == 2 );
+    CHECK( Stop( "18446744073709551616", size ) == 19 );
+    CHECK( Stop( "2 MB", size ) == 1 );
+    CHECK( Stop( "2mb", size ) == 1 );
+    CHECK( Stop( "2KB", size ) == 1 );
+    CHECK( Stop( "GiB", size ) == 0 );
+    CHECK( Stop( "1.5G", size ) == 1 );
+#endif
+
+    // IPv4 addresses: four numbers of 0 to 255, without leading zero
+    yaap::Ipv4Address address;
+    CHECK( Converts( "192.168.0.1", address ) && address.Value() == 0xC0A80001UL );
+    CHECK( address.octets[0] == 192 && address.octets[3] == 1 );
+    CHECK( Converts( "0.0.0.0", address ) && address.Value() == 0 );
+    CHECK( Converts( "255.255.255.255", address ) && address.Value() == 0xFFFFFFFFUL );
+    CHECK( Converts( "10.0.100.20", address ) && address.Value() == 0x0A006414UL );
+    CHECK( Stop( "01.2.3.4", address ) == 0 );
+    CHECK( Stop( "1.02.3.4", address ) == 2 );
+    CHECK( Stop( "1.2.3.00", address ) == 6 );
+    CHECK( Stop( "256.1.1.1", address ) == 2 );
+    CHECK( Stop( "1.2.3.1000", address ) == 9 );
+    CHECK( Stop( "1.2.3", address ) == 0 ); // too few numbers
+    CHECK( Stop( "1.2.3.", address ) == 0 );
+    CHECK( Stop( "1.2.3.4.", address ) == 7 ); // too many
+    CHECK( Stop( "1.2.3.4.5", address ) == 7 );
+    CHECK( Stop( "1.2..4", address ) == 4 );
+    CHECK( Stop( "1,2.3.4", address ) == 1 );
+    CHECK( Stop( "", address ) == 0 );
+    CHECK( Converts( "10.0.100.20", address ) && address.Value() == 0x0A006414UL ); // left by the failures
+    yaap::Ipv4Address other;
+    CHECK( Converts( "10.0.100.3", other ) && other < address && !( address < other ) && !( other == address ) );
+
+    // enumerations: one of the names, as a whole
+    Color color = Green;
+    CHECK( Converts( "red", color ) && color == Red );
+    CHECK( Converts( "blue", color ) && color == Blue );
+    CHECK( Stop( "green ", color ) == 0 && color == Blue );
+    CHECK( Stop( "gren", color ) == 0 );
+    CHECK( Stop( "re", color ) == 0 );
+    CHECK( Stop( "redd", color ) == 0 );
+    CHECK( Stop( "Red", color ) == 0 );
+    CHECK( Stop( "", color ) == 0 );
+
+    // the stop pointer is the offset of the error, SetRange() still applies
+    CommandLine line;
+    line << "-c" << "purple" << "-a" << "10.0.0.256" << "-m" << "10.2.0.1";
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    parser.AddOptionArg<Color>( 'c', "color", "Color", 1 );
+    parser.AddOptionArg<yaap::Ipv4Address>( 'a', "address", "Address", 1 );
+    yaap::OptionArg<yaap::Ipv4Address>* mask = parser.AddOptionArg<yaap::Ipv4Address>( 'm', "mask", "Mask", 1 );
+    yaap::Ipv4Address low, high;
+    CHECK( Converts( "10.0.0.0", low ) && Converts( "10.1.255.255", high ) );
+    mask->SetRange( low, high );
+    CHECK( !parser.Validate() );
+    const yaap::ErrorBuffer& errors = parser.Errors();
+    CHECK( errors.size() == 3 );
+    CHECK( errors.size() > 0 && errors[0].code == yaap::Error::BadValue && errors[0].argIndex == 2 && errors[0].offset == 0 );
+    CHECK( errors.size() > 1 && errors[1].code == yaap::Error::BadValue && errors[1].argIndex == 4 && errors[1].offset == 9 );
+    CHECK( errors.size() > 2 && errors[2].code == yaap::Error::OutOfRange && errors[2].option == mask );
+}
+
+//! Code, argument, offset and option of the errors of parser, as a string
+static std::string ErrorRecords( const yaap::Parser& parser )
+{
+    std::string records;
+    const yaap::ErrorBuffer& errors = parser.Errors();
+    for( const yaap::Error* it = errors.begin(); it != errors.end(); ++it )
+    {
+        char record[64];
+        std::sprintf( record, "%d %u %u %u\n", static_cast<int>( it->code ), it->argIndex, it->offset, it->id );
+        records += record;
+    }
+    return( records );
+}
+
+//! Parse the command line of TestLazyConversion() into parser
+static void AddLazyOptions( yaap::Parser& parser )
+{
+    parser.AddOptionArg<Counted>( 'c', "count", "Counted", 1 );
+    parser.AddOptionArg<int>( 'l', "list", "List", yaap::undef );
+    parser.AddOptionArg<int>( 'i', "id", "Id", 1 );
+    parser.AddOptionArg<int>( 'n', "number", "Two numbers", 2 );
+}
+
+static void TestLazyConversion( )
+{
+    CommandLine line;
+    line << "-c" << "12" << "-l" << "1,2x,3,4y" << "-i" << "9z" << "-n" << "5" << "6" << "-c" << "13";
+    yaap::Parser lazy( line.Argc(), line.Argv() );
+    lazy.SetLazyConversion( true );
+    nbConversions = 0;
+    AddLazyOptions( lazy );
+    yaap::OptionArg<Counted>* count = static_cast<yaap::OptionArg<Counted>*>( lazy.GetOption( 'c' ) );
+    yaap::OptionArg<int>* list = static_cast<yaap::OptionArg<int>*>( lazy.GetOption( 'l' ) );
+    yaap::OptionArg<int>* id = static_cast<yaap::OptionArg<int>*>( lazy.GetOption( 'i' ) );
+    // nothing is converted until a value is read
+    CHECK( nbConversions == 0 );
+    CHECK( count->GetNumberOfArguments() == 2 && count->GetNumberOfOccurrences() == 2 && nbConversions == 0 );
+    CHECK( list->GetNumberOfArguments() == 4 && list->GetOccurrenceSize( 0 ) == 4 );
+    CHECK( lazy.IsCommandLineValid() && !list->ErrorFlag() && !id->ErrorFlag() );
+    CHECK( count->GetValue().value == 12 && nbConversions == 2 );
+    CHECK( count->GetArgument( 1 ).value == 13 && nbConversions == 2 );
+    // a value read before Validate() still has its errors recorded
+    CHECK( list->GetArgument( 0 ) == 1 && list->ErrorFlag() );
+    CHECK( lazy.IsCommandLineValid() );
+    CHECK( !lazy.Validate() );
+    CHECK( list->ErrorFlag() && id->ErrorFlag() && !count->ErrorFlag() && !lazy.GetOption( 'n' )->ErrorFlag() );
+    CHECK( ErrorRecords( lazy ) == "2 4 3 1\n2 4 8 1\n2 6 1 2\n" );
+    CHECK( !lazy.Validate() && lazy.Errors().size() == 3 && nbConversions == 2 );
+
+    // the same errors as an eager parser
+    yaap::Parser eager( line.Argc(), line.Argv() );
+    AddLazyOptions( eager );
+    CHECK( nbConversions == 4 );
+    CHECK( !eager.IsCommandLineValid() && !eager.Validate() );
+    CHECK( ErrorRecords( eager ) == ErrorRecords( lazy ) );
+
+    // lazy conversion applies to the options added afterwards only
+    CommandLine more;
+    more << "-c" << "1" << "-k" << "2";
+    yaap::Parser mixed( more.Argc(), more.Argv() );
+    nbConversions = 0;
+    mixed.AddOptionArg<Counted>( 'c', "count", "Counted", 1 );
+    mixed.SetLazyConversion( true );
+    yaap::OptionArg<Counted>* late = mixed.AddOptionArg<Counted>( 'k', "kount", "Counted", 1 );
+    CHECK( nbConversions == 1 );
+    CHECK( late->GetValue().value == 2 && nbConversions == 2 );
+    CHECK( mixed.Validate() && mixed.Errors().empty() );
+}
+
+//! Copy of blob whose bytes [offset, offset + sizeof( T )) are replaced by value
+template<typename T>
+static std::string Corrupt( const std::string& blob, std::size_t offset, T value )
+{
+    std::string copy( blob );
+    std::memcpy( &copy[offset], &value, sizeof( T ) );
+    return( copy );
+}
+
+static void TestSerialization( )
+{
+    CommandLine line;
+    line << "-v" << "-o" << "out" << "-n" << "3" << "4" << "-r" << "1.5" << "-l" << "a,,bc" << "-a" << "10.0.0.1"
+         << "--" << "7" << "rest" << "" << "more";
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    parser.AddOption( 'v', "verbose", "Verbose" );
+    parser.AddOption( 'q', "quiet", "Quiet" );
+    parser.AddOptionArg<std::string>( 'o', "output", "Output", 1 );
+    parser.AddOptionArg<int>( 'n', "number", "Numbers", 2 );
+    parser.AddOptionArg<double>( 'r', "ratio", "Ratio", 1 );
+    parser.AddOptionArg<std::string>( 'l', "list", "List", yaap::undef );
+    parser.AddOptionArg<yaap::Ipv4Address>( 'a', "address", "Address", 1 );
+    parser.AddOperand<int>( "Count" );
+    std::string blob;
+    parser.Serialize( blob );
+    CHECK( blob.size() % 8 == 0 );
+
+    yaap::ResultView view;
+    CHECK( view.Attach( blob.data(), blob.size() ) );
+    CHECK( view.IsCommandLineValid() && view.GetNumberOfOptions() == 7 );
+    CHECK( view.Find( 'v' ) == 0 && view.Find( "list" ) == 5 && view.Find( 'x' ) == yaap::OptionIndex::npos );
+    CHECK( view.Exists( 0 ) && !view.Exists( 1 ) && !view.ErrorFlag( 0 ) );
+    CHECK( view.GetValue<std::string>( 2 ) == "out" );
+    CHECK( view.GetNumberOfArguments( 3 ) == 2 && view.GetArgument<int>( 3, 0 ) == 3 && view.GetArgument<int>( 3, 1 ) == 4 );
+    CHECK( view.GetValue<double>( 4 ) == 1.5 );
+    CHECK( view.GetNumberOfArguments( 5 ) == 3 && view.GetArgument<std::string>( 5, 0 ) == "a"
+           && view.GetArgument<std::string>( 5, 1 ).empty() && view.GetArgument<std::string>( 5, 2 ) == "bc" );
+    int count = 0;
+    CHECK( view.GetNumberOfOperands() == 1 && view.GetOperand( 0, count ) && count == 7 );
+    CHECK( view.GetNumberOfRemainingOperands() == 3 && std::strcmp( view.GetRemainingOperand( 0 ), "rest" ) == 0
+           && view.GetRemainingOperand( 1 )[0] == '\0' && std::strcmp( view.GetRemainingOperand( 2 ), "more" ) == 0 );
+
+    // a value is read only as the type it was stored as
+    int number = -1;
+    long long wide = -1;
+    unsigned int natural = 1;
+    float single = 0;
+    std::string text = "kept";
+    CHECK( !view.GetArgument( 2, 0, number ) && number == -1 );
+    CHECK( !view.GetArgument( 3, 0, wide ) && wide == -1 );
+    CHECK( !view.GetArgument( 3, 0, natural ) && natural == 1 );
+    CHECK( !view.GetArgument( 3, 0, text ) && text == "kept" );
+    CHECK( !view.GetArgument( 4, 0, single ) );
+    CHECK( !view.GetArgument( 3, 2, number ) ); // past the values
+    yaap::Ipv4Address address;
+    CHECK( view.Exists( 6 ) && !view.GetArgument( 6, 0, address ) ); // not stored
+    CHECK( view.GetArgument<int>( 2, 0 ) == 0 && view.GetValue<std::string>( 3 ).empty() );
+    CHECK( !view.GetOperand( 0, text ) );
+
+    // truncated or corrupt blobs are rejected
+    CHECK( !view.Attach( blob.data(), 0 ) );
+    CHECK( !view.Attach( blob.data(), sizeof( yaap::detail::BlobHeader ) - 1 ) );
+    CHECK( !view.Attach( blob.data(), blob.size() - 8 ) );
+    std::string longer = blob + std::string( 8, '\0' );
+    CHECK( !view.Attach( longer.data(), longer.size() ) );
+    std::string unterminated( blob );
+    unterminated[unterminated.size() - 1] = 'x';
+    CHECK( !view.Attach( unterminated.data(), unterminated.size() ) );
+    std::string magic( blob );
+    magic[7] = '0';
+    CHECK( !view.Attach( magic.data(), magic.size() ) );
+    const std::size_t header = sizeof( yaap::detail::BlobHeader ), record = sizeof( yaap::detail::BlobRecord );
+    const unsigned int huge = 0x7FFFFFFFU;
+    std::string options = Corrupt( blob, offsetof( yaap::detail::BlobHeader, nbOptions ), huge );
+    CHECK( !view.Attach( options.data(), options.size() ) );
+    std::string arguments = Corrupt( blob, offsetof( yaap::detail::BlobHeader, nbArguments ), huge );
+    CHECK( !view.Attach( arguments.data(), arguments.size() ) );
+    std::string name = Corrupt( blob, header + offsetof( yaap::detail::BlobRecord, name ), huge );
+    CHECK( !view.Attach( name.data(), name.size() ) );
+    std::string values = Corrupt( blob, header + 3 * record + offsetof( yaap::detail::BlobRecord, values ), huge );
+    CHECK( !view.Attach( values.data(), values.size() ) );
+    std::string counted = Corrupt( blob, header + 3 * record + offsetof( yaap::detail::BlobRecord, count ), huge );
+    CHECK( !view.Attach( counted.data(), counted.size() ) );
+    std::string sized = Corrupt( blob, header + 3 * record + offsetof( yaap::detail::BlobRecord, elementSize ), 0U );
+    CHECK( !view.Attach( sized.data(), sized.size() ) );
+    CHECK( view.Attach( blob.data(), blob.size() ) && view.GetValue<double>( 4 ) == 1.5 );
+
+    // the error flags and the validity are kept
+    CommandLine wrong;
+    wrong << "-n" << "3" << "x4";
+    yaap::Parser invalid( wrong.Argc(), wrong.Argv() );
+    invalid.AddOptionArg<int>( 'n', "number", "Numbers", 2 );
+    invalid.Serialize( blob );
+    CHECK( view.Attach( blob.data(), blob.size() ) );
+    CHECK( !view.IsCommandLineValid() && view.ErrorFlag( 0 ) && view.GetArgument<int>( 0, 0 ) == 3 );
+}
+
+static void TestBoundValues( )
+{
+    CommandLine line;
+    line << "-s" << ".5" << "1" << "2" << "-i" << "1" << "-c" << "5" << "-i" << "2" << "-p" << "3" << "4";
+    yaap::Parser parser( line.Argc(), line.Argv() );
+    parser.SetLazyConversion( true ); // bound options are converted at once anyway
+    double spacing[3] = { 9, 9, 9 };
+    int ids[1] = { 0 };
+    Counted counted[1];
+    int absent[2] = { -1, -1 };
+    nbConversions = 0;
+    yaap::OptionArg<double>* spacingOption = parser.AddOptionArg( 's', "spacing", "Spacing", spacing, 3 );
+    yaap::OptionArg<int>* idsOption = parser.AddOptionArg( 'i', "id", "Id", ids, 1 );
+    yaap::OptionArg<Counted>* countedOption = parser.AddOptionArg( 'c', "count", "Counted", counted, 1 );
+    yaap::OptionArg<int>* absentOption = parser.AddOptionArg( 'x', "absent", "Absent", absent, 2 );
+    // the values are written in place, at parse time
+    CHECK( spacing[0] == 0.5 && spacing[1] == 1 && spacing[2] == 2 );
+    CHECK( counted[0].value == 5 && nbConversions == 1 );
+    CHECK( absent[0] == -1 && absent[1] == -1 && !absentOption->Exists() && absentOption->GetNumberOfArguments() == 0 );
+    CHECK( spacingOption->GetNumberOfArguments() == 3 && spacingOption->GetArgument( 1 ) == 1 );
+    CHECK( countedOption->GetValue().value == 5 && nbConversions == 1 );
+    // a repetition that does not fit is refused
+    CHECK( ids[0] == 1 && idsOption->GetValue() == 1 && idsOption->GetNumberOfArguments() == 1 );
+    CHECK( idsOption->Overflowed() && idsOption->ErrorFlag() && !spacingOption->Overflowed() );
+    CHECK( !parser.IsCommandLineValid() && parser.Errors().size() == 1 );
+    CHECK( parser.Errors().size() == 1 && parser.Errors()[0].code == yaap::Error::TooManyValues
+           && parser.Errors()[0].argIndex == 10 && parser.Errors()[0].offset == 0 && parser.Errors()[0].option == idsOption );
+    CHECK( std::strcmp( yaap::Error::Message( yaap::Error::TooManyValues ), "too many option-arguments" ) == 0 );
+
+#if __cplusplus >= 201103L
+    std::array<int, 2> pair = { { 0, 0 } };
+    yaap::OptionArg<int>* pairOption = parser.AddOptionArg( 'p', "pair", "Pair", pair );
+    CHECK( pair[0] == 3 && pair[1] == 4 && pairOption->GetArgument( 1 ) == 4 && !pairOption->ErrorFlag() );
+#endif
+#ifdef YAAP_HAS_CXX20
+    CommandLine spanLine;
+    spanLine << "--span" << "5" << "6";
+    yaap::Parser spanParser( spanLine.Argc(), spanLine.Argv() );
+    int span[2] = { 0, 0 };
+    spanParser.AddOptionArg( 'q', "span", "Span", std::span<int, 2>( span ) );
+    CHECK( span[0] == 5 && span[1] == 6 && spanParser.IsCommandLineValid() );
+#endif
+
+    // the blob holds the values of the buffers
+    std::string blob;
+    parser.Serialize( blob );
+    yaap::ResultView view;
+    CHECK( view.Attach( blob.data(), blob.size() ) );
+    CHECK( view.GetNumberOfArguments( 0 ) == 3 && view.GetArgument<double>( 0, 0 ) == 0.5 && view.GetArgument<double>( 0, 2 ) == 2 );
+    CHECK( view.GetNumberOfArguments( 1 ) == 1 && view.GetValue<int>( 1 ) == 1 && view.ErrorFlag( 1 ) );
+    CHECK( view.GetNumberOfArguments( 3 ) == 0 && !view.Exists( 3 ) );
+
+    // a wrong value is reported at its argument
+    CommandLine wrong;
+    wrong << "-s" << "1" << "x" << "2";
+    yaap::Parser invalid( wrong.Argc(), wrong.Argv() );
+    double values[3] = { 0, 0, 0 };
+    invalid.AddOptionArg( 's', "spacing", "Spacing", values, 3 );
+    CHECK( values[0] == 1 && values[2] == 2 );
+    CHECK( invalid.Errors().size() == 1 && invalid.Errors()[0].code == yaap::Error::BadValue
+           && invalid.Errors()[0].argIndex == 3 );
+}
+
+static void TestUsage( )
+{
+    CommandLine line;
+    line << "-n" << "3";
+    yaap::Parser parser( line.Argc(), line.Argv(), "Usage test" );
+    yaap::Option* verbose = parser.AddOption( 'v', "verbose", "Verbose" );
+    parser.AddOptionArg<int>( 'n', "number", "Number", 1 );
+    const std::string first = parser.GetUsage();
+    CHECK( first.find( "Usage test" ) != std::string::npos && first.find( "\t-n/--number : Number" ) != std::string::npos );
+    CHECK( first.find( '*' ) == first.rfind( '*' ) ); // the footer only
+    CHECK( parser.GetUsage() == first && &parser.GetUsage() == &parser.GetUsage() );
+
+    // the text is rendered again after a change of the options, of the
+    // description or of an error flag
+    parser.AddOption( 'z', "zeta", "Zeta" );
+    const std::string added = parser.GetUsage();
+    CHECK( added.find( " [-z/--zeta]" ) != std::string::npos && added.find( "\t-z/--zeta : Zeta" ) != std::string::npos );
+    parser.SetDescription( "Other description" );
+    CHECK( parser.GetUsage().find( "Other description" ) != std::string::npos );
+    CHECK( parser.GetUsage().find( "Usage test" ) == std::string::npos );
+    verbose->RaiseError();
+    CHECK( parser.GetUsage().find( "     *\t-v/--verbose" ) != std::string::npos );
+    parser.Update( 2, "x" );
+    CHECK( parser.GetUsage().find( "     *\t-n/--number" ) != std::string::npos );
+    parser.Update( 2, "4" );
+    CHECK( parser.GetUsage().find( "     *\t-n/--number" ) == std::string::npos );
+    CHECK( parser.GetUsage().find( "     *\t-v/--verbose" ) != std::string::npos );
+
+    // a buffer too small gets the start of the text, null-terminated
+    const std::string text = parser.GetUsage();
+    char buffer[16];
+    std::memset( buffer, '#', sizeof( buffer ) );
+    CHECK( parser.Usage( buffer, 8 ) == text.size() );
+    CHECK( text.compare( 0, 7, buffer, 7 ) == 0 && buffer[7] == '\0' && buffer[8] == '#' );
+    CHECK( parser.Usage( buffer, 1 ) == text.size() && buffer[0] == '\0' && buffer[1] == text[1] );
+    buffer[0] = '#';
+    CHECK( parser.Usage( buffer, 0 ) == text.size() && buffer[0] == '#' );
+    CHECK( parser.Usage( NULL, 0 ) == text.size() );
+    std::vector<char> whole( text.size() + 2, '#' );
+    CHECK( parser.Usage( &whole[0], text.size() + 1 ) == text.size() );
+    CHECK( std::string( &whole[0] ) == text && whole[text.size() + 1] == '#' );
+    std::vector<char> exact( text.size(), '#' );
+    CHECK( parser.Usage( &exact[0], text.size() ) == text.size() );
+    CHECK( text.compare( 0, text.size() - 1, &exact[0], text.size() - 1 ) == 0 && exact[text.size() - 1] == '\0' );
+}
+
+//! Add a --jobs option and count the calls, see TestSubcommands()
+struct SubcommandBuilder {
+    SubcommandBuilder( unsigned int& calls, char flag ) : calls( &calls ), flag( flag ) {};
+
+    void operator()( yaap::Parser& parser ) const
+    {
+        ( *this->calls )++;
+        parser.AddOptionArg<int>( this->flag, "jobs", "Parallel jobs", 1 );
+    };
+
+    unsigned int* calls;
+    char flag;
+};
+
+static void TestSubcommands( )
+{
+    // only the builder of the selected subcommand runs
+    {
+        CommandLine line;
+        line << "build" << "-j" << "4" << "file" << "test";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        unsigned int builds = 0, tests = 0, again = 0;
+        CHECK( parser.GetSubcommand().empty() );
+        CHECK( !parser.AddSubcommand( "test", SubcommandBuilder( tests, 't' ), "Run the tests" ) );
+        CHECK( parser.AddSubcommand( "build", SubcommandBuilder( builds, 'j' ), "Build the targets" ) );
+        CHECK( !parser.AddSubcommand( "build", SubcommandBuilder( again, 'k' ), "Build again" ) );
+        CHECK( builds == 1 && tests == 0 && again == 0 );
+        CHECK( parser.GetSubcommand() == "build" );
+        yaap::OptionArg<int>* jobs = static_cast<yaap::OptionArg<int>*>( parser.GetOption( 'j' ) );
+        CHECK( jobs != NULL && jobs->GetValue() == 4 && parser.GetOption( 't' ) == NULL && parser.GetOption( 'k' ) == NULL );
+        CHECK( parser.IsCommandLineValid() );
+        // the subcommand is not an operand: without "--", the operands are
+        // guessed from the argument that follows it
+        std::vector<std::string> operands = Operands( parser );
+        CHECK( operands.size() == 4 && operands[0] == "-j" && operands[3] == "test" );
+        const std::string& usage = parser.GetUsage();
+        CHECK( usage.find( "[shell]$ checkyaap build [-j/--jobs" ) != std::string::npos );
+        CHECK( usage.find( "<subcommand>" ) == std::string::npos && usage.find( "Subcommands:" ) == std::string::npos );
+    }
+    {
+        CommandLine line;
+        line << "build" << "--" << "file";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        unsigned int builds = 0;
+        CHECK( parser.AddSubcommand( "build", SubcommandBuilder( builds, 'j' ) ) );
+        std::vector<std::string> operands = Operands( parser );
+        CHECK( operands.size() == 1 && operands[0] == "file" );
+    }
+
+    // a subcommand is only the first argument
+    {
+        CommandLine line;
+        line << "-v" << "build";
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        parser.AddOption( 'v', "verbose", "Verbose" );
+        unsigned int builds = 0, tests = 0;
+        CHECK( !parser.AddSubcommand( "build", SubcommandBuilder( builds, 'j' ), "Build the targets" ) );
+        CHECK( !parser.AddSubcommand( "test", SubcommandBuilder( tests, 't' ), "Run the tests" ) );
+        CHECK( builds == 0 && tests == 0 && parser.GetSubcommand().empty() && parser.GetOption( 'j' ) == NULL );
+        const std::string& usage = parser.GetUsage();
+        CHECK( usage.find( "[shell]$ checkyaap <subcommand> [-v/--verbose]" ) != std::string::npos );
+        CHECK( usage.find( "Subcommands:\n\tbuild : Build the targets\n\ttest : Run the tests\n" ) != std::string::npos );
+    }
+    {
+        CommandLine line;
+        yaap::Parser parser( line.Argc(), line.Argv() );
+        unsigned int builds = 0;
+        CHECK( !parser.AddSubcommand( "build", SubcommandBuilder( builds, 'j' ) ) && builds == 0 );
+        CHECK( parser.GetSubcommand().empty() && Operands( parser ).empty() );
+    }
+}
+
+int main( )
+{
+    TestResponseFiles();
+#ifdef YAAP_HAS_THREADS
+    TestPrefetch();
+#endif
+    TestConfiguration();
+    TestFlaglessOptions();
+    TestDuplicateOptions();
+    TestConstraints();
+    TestLazyConversion();
+    TestSerialization();
+    TestBoundValues();
+    TestUsage();
+    TestSubcommands();
+    TestWideCommandLines();
+    TestConverters();
+    std::printf( "checkyaap: %u checks, %u failures\n", nbChecks, nbFailures );
+    return( nbFailures == 0 ? 0 : 1 );
+}
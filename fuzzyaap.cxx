@@ -0,0 +1,705 @@
+//! \file fuzzyaap.cxx
+//! \brief Fuzzing and differential testing of the yaap parsing paths
+//!
+//! Built with the YAAP_BUILD_FUZZERS CMake option. The input bytes are split
+//! on '\0' into the arguments of a command line, which is parsed by Parser
+//! and by Layout against the same options, and by Reference, a plain copy of
+//! the original rescanning parser (one pass over argv per option, stream
+//! conversions). Any difference between them aborts. A Parser edited with
+//! Insert(), Erase() and Update() is also compared with a new Parser of the
+//! edited command line, and a Parser with lazy conversion with an eager one.
+//! In C++17, the command lines whose options all precede the operands are
+//! also parsed by a Schema of the same options.
+//!
+//! yaap_fuzz_libfuzzer is a libFuzzer target, only built with Clang:
+//!   [shell]$ yaap_fuzz_libfuzzer -max_len=512 corpus/
+//! yaap_fuzz runs the files given on its command line, which suits AFL
+//! (afl-fuzz -i in -o out -- yaap_fuzz @@) and replaying crashes, or else a
+//! number of random command lines built from the tokens yaap cares about:
+//!   [shell]$ yaap_fuzz -runs 100000 -seed 7
+
+#include "yaap.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//! Argument vector built from the fuzzer input
+class CommandLine {
+public:
+    //! Split [data, data + size) on '\0', after a program name
+    CommandLine( const char* data, std::size_t size )
+    {
+        this->strings.push_back( "fuzzyaap" );
+        const char* end = data + size;
+        while( data < end && this->strings.size() < MaxArgs )
+        {
+            const char* next = static_cast<const char*>( std::memchr( data, '\0', end - data ) );
+            if( next == NULL )
+                next = end;
+            this->strings.push_back( std::string( data, next ) );
+            data = next + 1;
+        }
+        for( std::size_t i = 0; i < this->strings.size(); i++ )
+            this->argv.push_back( &this->strings[i][0] );
+        this->argv.push_back( NULL );
+    };
+
+    int Argc( ) const {
+        return( static_cast<int>( this->strings.size() ) );
+    };
+
+    char** Argv( ) {
+        return( &this->argv[0] );
+    };
+
+    //! Print the command line on stderr, one argument per line
+    void Print( ) const
+    {
+        for( std::size_t i = 0; i < this->strings.size(); i++ )
+            std::fprintf( stderr, "  argv[%u] = \"%s\"\n", static_cast<unsigned int>( i ), this->strings[i].c_str() );
+    };
+
+private:
+    enum { MaxArgs = 64 };
+
+    std::vector<std::string> strings;
+    std::vector<char*> argv;
+};
+
+//! \class Reference
+//! \brief The original option-by-option parser
+//!
+//! Kept as simple as the first yaap: every option scans the whole argument
+//! vector and converts its arguments with a stream. Only the reads past the
+//! end of the short arguments are fixed. Values are kept as strings.
+class Reference {
+public:
+    struct Option {
+        char flag;
+        std::string longName;
+        bool hasArgs;
+        unsigned int nbsubargs;
+        bool integer; //!< the arguments are converted to int
+        unsigned int count; //!< number of occurrences
+        bool error; //!< an argument is missing or wrong
+        bool extension; //!< an int argument is not decimal, see IsDecimal()
+        std::vector<std::vector<std::string> > occurrences; //!< arguments of each occurrence
+    };
+
+    Reference( int argc, char** argv ) : nbArgs( argc ), argv( argv ) {};
+
+    void AddOption( char flag, std::string longName )
+    {
+        Option option = this->Make( flag, longName, false, 0, false );
+        for( unsigned int i = 1; i < this->nbArgs; i++ )
+        {
+            if( this->argv[i][0] == '-' )
+            {
+                unsigned int c = 1;
+                while( this->argv[i][c] != '\0' && this->argv[i][c] != '-' )
+                {
+                    if( this->argv[i][c] == option.flag )
+                        option.count++;
+                    c++;
+                }
+            }
+            if( this->IsLongName( this->argv[i], option.longName ) )
+                option.count++;
+        }
+        this->options.push_back( option );
+    };
+
+    void AddOptionArg( char flag, std::string longName, unsigned int nbsubargs, bool integer )
+    {
+        Option option = this->Make( flag, longName, true, nbsubargs, integer );
+        for( unsigned int i = 1; i < this->nbArgs; i++ )
+        {
+            if( !( this->argv[i][0] == '-' && option.flag != '\0' && this->argv[i][1] == option.flag )
+             && !this->IsLongName( this->argv[i], option.longName ) )
+                continue;
+            option.count++;
+            option.occurrences.push_back( std::vector<std::string>() );
+            std::vector<std::string>& args = option.occurrences.back();
+            if( i + ( nbsubargs == yaap::undef ? 1 : nbsubargs ) >= this->nbArgs )
+            {
+                option.error = true;
+                continue;
+            }
+            if( nbsubargs == yaap::undef )
+            {
+                std::stringstream list( this->argv[i + 1] );
+                std::string arg;
+                while( std::getline( list, arg, ',' ) )
+                    args.push_back( arg );
+            }
+            else
+                for( unsigned int argIdx = 1; argIdx <= nbsubargs; argIdx++ )
+                    args.push_back( this->argv[i + argIdx] );
+            for( unsigned int pos = 0; integer && pos < args.size(); pos++ )
+            {
+                int value;
+                if( !Reference::IsDecimal( args[pos] ) )
+                    option.extension = true;
+                else if( !Reference::Convert( args[pos], value ) )
+                    option.error = true;
+            }
+        }
+        this->options.push_back( option );
+    };
+
+    const Option& GetOption( unsigned int id ) const {
+        return( this->options[id] );
+    };
+
+    //! Stream conversion of the whole string, as done by the first yaap
+    static bool Convert( const std::string& arg, int& value )
+    {
+        std::istringstream stream( arg );
+        stream >> value;
+        return( !stream.fail() && stream.eof() );
+    };
+
+    //! If true, arg is made of an optional sign and decimal digits only, on
+    //! which the stream and the yaap converters must agree
+    static bool IsDecimal( const std::string& arg )
+    {
+        std::size_t first = ( !arg.empty() && ( arg[0] == '-' || arg[0] == '+' ) ) ? 1 : 0;
+        return( first < arg.size() && arg.find_first_not_of( "0123456789", first ) == std::string::npos );
+    };
+
+private:
+    Option Make( char flag, const std::string& longName, bool hasArgs, unsigned int nbsubargs, bool integer )
+    {
+        Option option;
+        option.flag = flag;
+        option.longName = longName;
+        option.hasArgs = hasArgs;
+        option.nbsubargs = nbsubargs;
+        option.integer = integer;
+        option.count = 0;
+        option.error = false;
+        option.extension = false;
+        return( option );
+    };
+
+    //! If true, arg is "--longName". Checks arg[1] and arg[2] before looking
+    //! at arg + 2, which the first yaap did not.
+    static bool IsLongName( const char* arg, const std::string& longName ) {
+        return( arg[0] == '-' && arg[1] == '-' && arg[2] != '\0' && longName.compare( arg + 2 ) == 0 );
+    };
+
+    unsigned int nbArgs; //!< number of arguments (argc)
+    char** argv; //!< argument vector
+    std::vector<Option> options; //!< options, in order of addition
+};
+
+//! Report a difference between the parsers and abort
+static void Fail( CommandLine& commandLine, const char* what, const std::string& longName )
+{
+    std::fprintf( stderr, "fuzzyaap: %s differs for --%s on\n", what, longName.c_str() );
+    commandLine.Print();
+    std::abort();
+}
+
+//! Check the string or int values of the option id in parser, result and reference
+template<typename T>
+static void CompareArguments( CommandLine& commandLine, yaap::Parser& parser, const yaap::ParseResult& result,
+                              const Reference& reference, unsigned int id )
+{
+    const Reference::Option& expected = reference.GetOption( id );
+    yaap::OptionArg<T>* option = static_cast<yaap::OptionArg<T>*>( parser.GetOption( expected.longName ) );
+    if( option->GetNumberOfOccurrences() != expected.occurrences.size() )
+        Fail( commandLine, "number of occurrences", expected.longName );
+    std::size_t nbArguments = 0;
+    for( unsigned int occ = 0; occ < expected.occurrences.size(); occ++ )
+    {
+        const std::vector<std::string>& args = expected.occurrences[occ];
+        if( option->GetOccurrenceSize( occ ) != args.size() )
+            Fail( commandLine, "occurrence size", expected.longName );
+        for( unsigned int pos = 0; pos < args.size(); pos++, nbArguments++ )
+        {
+            // the same characters in Layout and in the reference
+            yaap::Span span = result.GetSpan( id, static_cast<unsigned int>( nbArguments ) );
+            if( args[pos].compare( 0, std::string::npos, span.first, span.last - span.first ) != 0 )
+                Fail( commandLine, "argument", expected.longName );
+            // the same value in Parser and in Layout
+            T value = T();
+            bool converted = result.GetArgument( id, static_cast<unsigned int>( nbArguments ), value );
+            if( converted && !( option->GetOccurrenceArgument( occ, pos ) == value ) )
+                Fail( commandLine, "value", expected.longName );
+        }
+    }
+    if( result.GetNumberOfArguments( id ) != nbArguments )
+        Fail( commandLine, "number of arguments", expected.longName );
+}
+
+//! Check the string or int values of the option id in parser and in view
+template<typename T>
+static void CompareSerialized( CommandLine& commandLine, yaap::Parser& parser, const yaap::ResultView& view,
+                               const Reference& reference, unsigned int id )
+{
+    const std::string& longName = reference.GetOption( id ).longName;
+    yaap::OptionArg<T>* option = static_cast<yaap::OptionArg<T>*>( parser.GetOption( longName ) );
+    if( view.GetNumberOfArguments( id ) != option->GetNumberOfArguments() )
+        Fail( commandLine, "serialized number of arguments", longName );
+    for( unsigned int pos = 0; pos < option->GetNumberOfArguments(); pos++ )
+    {
+        T value = T();
+        if( !view.GetArgument( id, pos, value ) || !( value == option->GetArgument( pos ) ) )
+            Fail( commandLine, "serialized value", longName );
+    }
+    // the values are not read as another type
+    double other = 0;
+    if( view.GetArgument( id, 0, other ) )
+        Fail( commandLine, "serialized type", longName );
+}
+
+//! Check the int conversions against the stream conversion of the reference
+static void CompareConversions( CommandLine& commandLine, const yaap::ParseResult& result,
+                                const Reference& reference, unsigned int id )
+{
+    const Reference::Option& expected = reference.GetOption( id );
+    unsigned int pos = 0;
+    for( unsigned int occ = 0; occ < expected.occurrences.size(); occ++ )
+        for( unsigned int k = 0; k < expected.occurrences[occ].size(); k++, pos++ )
+        {
+            const std::string& arg = expected.occurrences[occ][k];
+            if( !Reference::IsDecimal( arg ) )
+                continue; // hexadecimal and friends are yaap extensions
+            int value = 0, expectedValue = 0;
+            bool converted = result.GetArgument( id, pos, value );
+            if( converted != Reference::Convert( arg, expectedValue )
+             || ( converted && value != expectedValue ) )
+                Fail( commandLine, "int conversion", expected.longName );
+        }
+}
+
+//! Options of the edited parsers, see CompareEditions()
+static void AddOptions( yaap::Parser& parser )
+{
+    parser.AddOption( 'v', "verbose", "Verbose output" );
+    parser.AddOption( 'q', "quiet", "Quiet output" );
+    parser.AddOptionArg<std::string>( 'o', "output", "Output file", 1 );
+    parser.AddOptionArg<int>( 'n', "number", "Two numbers", 2 );
+    parser.AddOptionArg<std::string>( 'l', "list", "List of names", yaap::undef );
+    parser.AddOperand<std::string>( "Input" );
+}
+
+//! Counts, error flags, arguments, errors and operands of parser, as a string
+static std::string Summary( yaap::Parser& parser )
+{
+    parser.Validate();
+    std::ostringstream out;
+    const char* const names[] = { "verbose", "quiet", "output", "number", "list" };
+    for( unsigned int id = 0; id < 5; id++ )
+    {
+        yaap::Option* option = parser.GetOption( std::string( names[id] ) );
+        out << names[id] << ' ' << option->Count() << ' ' << option->ErrorFlag() << '\n';
+    }
+    yaap::OptionArg<std::string>* output = static_cast<yaap::OptionArg<std::string>*>( parser.GetOption( 'o' ) );
+    for( unsigned int pos = 0; pos < output->GetNumberOfArguments(); pos++ )
+        out << "output " << output->GetArgument( pos ) << '\n';
+    yaap::OptionArg<int>* number = static_cast<yaap::OptionArg<int>*>( parser.GetOption( 'n' ) );
+    for( unsigned int pos = 0; pos < number->GetNumberOfArguments(); pos++ )
+        out << "number " << number->GetArgument( pos ) << '\n';
+    yaap::OptionArg<std::string>* list = static_cast<yaap::OptionArg<std::string>*>( parser.GetOption( 'l' ) );
+    for( unsigned int occ = 0; occ < list->GetNumberOfOccurrences(); occ++ )
+        out << "list " << list->GetOccurrenceSize( occ ) << '\n';
+    // the errors of the options not parsed again come first after an edition
+    std::vector<std::string> errors;
+    for( std::size_t k = 0; k < parser.Errors().size(); k++ )
+    {
+        const yaap::Error& error = parser.Errors()[k];
+        std::ostringstream record;
+        record << "error " << error.code << ' ' << error.argIndex << ' ' << error.offset << ' ' << error.id << '\n';
+        errors.push_back( record.str() );
+    }
+    std::sort( errors.begin(), errors.end() );
+    for( std::size_t k = 0; k < errors.size(); k++ )
+        out << errors[k];
+    out << "operand " << static_cast<yaap::Operand<std::string>*>( parser.GetOperand( 0 ) )->GetValue() << '\n';
+    out << "operands " << parser.Operands<std::string>().size() << '\n';
+    return( out.str() );
+}
+
+//! Compare an edited Parser with a Parser of the edited command line. They
+//! may keep different errors once the error buffer is full.
+static void CompareEdition( CommandLine& commandLine, yaap::Parser& edited, std::vector<char*>& args )
+{
+    std::vector<char*> argv( args );
+    argv.push_back( NULL );
+    yaap::Parser parser( static_cast<int>( args.size() ), &argv[0] );
+    AddOptions( parser );
+    if( Summary( edited ) != Summary( parser )
+     && edited.Errors().size() < yaap::ErrorBuffer::Capacity && parser.Errors().size() < yaap::ErrorBuffer::Capacity )
+        Fail( commandLine, "edited parser", "" );
+}
+
+//! Check Parser::Insert(), Erase() and Update() against new Parsers
+static void CompareEditions( CommandLine& commandLine )
+{
+    int argc = commandLine.Argc();
+    char** argv = commandLine.Argv();
+    if( argc < 2 )
+        return;
+    std::vector<char*> args( argv, argv + argc );
+    {
+        // the last argument inserted
+        char* last = argv[argc - 1];
+        argv[argc - 1] = NULL;
+        yaap::Parser edited( argc - 1, argv );
+        argv[argc - 1] = last;
+        AddOptions( edited );
+        edited.Insert( argc - 1, last );
+        CompareEdition( commandLine, edited, args );
+    }
+    {
+        // the first argument erased, then the last one replaced by it
+        yaap::Parser edited( argc, argv );
+        AddOptions( edited );
+        edited.Erase( 1 );
+        args.erase( args.begin() + 1 );
+        CompareEdition( commandLine, edited, args );
+        if( argc >= 3 )
+        {
+            edited.Update( argc - 2, argv[1] );
+            args[argc - 2] = argv[1];
+            CompareEdition( commandLine, edited, args );
+        }
+    }
+}
+
+//! Compare a Parser with lazy conversion with an eager one, once validated
+static void CompareLazyConversion( CommandLine& commandLine )
+{
+    yaap::Parser eager( commandLine.Argc(), commandLine.Argv() );
+    AddOptions( eager );
+    yaap::Parser lazy( commandLine.Argc(), commandLine.Argv() );
+    lazy.SetLazyConversion( true );
+    AddOptions( lazy );
+    if( Summary( lazy ) != Summary( eager ) )
+        Fail( commandLine, "lazy parser", "" );
+}
+
+#ifdef YAAP_HAS_CXX17
+struct Verbose : yaap::Field<'v'> {
+    static constexpr const char* longName = "verbose";
+    static constexpr const char* description = "Verbose output";
+};
+struct Quiet : yaap::Field<'q'> {
+    static constexpr const char* longName = "quiet";
+    static constexpr const char* description = "Quiet output";
+};
+struct Output : yaap::Field<'o', std::string> {
+    static constexpr const char* longName = "output";
+    static constexpr const char* description = "Output file";
+};
+struct Number : yaap::Field<'n', int, 2> {
+    static constexpr const char* longName = "number";
+    static constexpr const char* description = "Two numbers";
+};
+struct List : yaap::Field<'l', std::string, yaap::undef> {
+    static constexpr const char* longName = "list";
+    static constexpr const char* description = "List of names";
+};
+struct Ids : yaap::Field<'i', int, yaap::undef> {
+    static constexpr const char* longName = "ids";
+    static constexpr const char* description = "List of identifiers";
+};
+typedef yaap::Schema<Verbose, Quiet, Output, Number, List, Ids> FuzzSchema;
+
+//! Number of option-arguments of the option flag or longName of FuzzSchema
+static int NumberOfArguments( char flag, const char* longName )
+{
+    const char flags[] = { 'o', 'n', 'l', 'i' };
+    const char* const longNames[] = { "output", "number", "list", "ids" };
+    const int nbArgs[] = { 1, 2, 1, 1 };
+    for( unsigned int k = 0; k < 4; k++ )
+        if( ( longName == NULL && flag == flags[k] ) || ( longName != NULL && std::strcmp( longName, longNames[k] ) == 0 ) )
+            return( nbArgs[k] );
+    return( 0 );
+}
+
+//! If true, the command line reads the same to Parser, which finds the
+//! options anywhere in argv, and to Schema, which stops at the first
+//! operand: the options precede the operands, no option-argument starts
+//! with '-' and, in a cluster, only the first flag takes option-arguments.
+//! delimited is set if the options end with "--".
+static bool IsOrdered( int argc, char** argv, bool& delimited )
+{
+    delimited = false;
+    int i = 1;
+    for( ; i < argc; i++ )
+    {
+        const char* arg = argv[i];
+        if( arg[0] != '-' || arg[1] == '\0' )
+            break;
+        int nbArgs = 0;
+        if( arg[1] == '-' )
+        {
+            if( arg[2] == '\0' )
+            {
+                delimited = true;
+                i++;
+                break;
+            }
+            nbArgs = NumberOfArguments( '\0', arg + 2 );
+        }
+        else
+        {
+            nbArgs = NumberOfArguments( arg[1], NULL );
+            for( unsigned int c = 2; arg[c] != '\0'; c++ )
+                if( arg[c] == '-' || NumberOfArguments( arg[c], NULL ) != 0 )
+                    return( false );
+        }
+        for( ; nbArgs > 0 && i + 1 < argc; nbArgs-- )
+            if( argv[++i][0] == '-' )
+                return( false );
+    }
+    for( ; i < argc; i++ )
+        if( argv[i][0] == '-' && argv[i][1] != '\0' )
+            return( false );
+    return( true );
+}
+
+//! Check the Schema against the Parser of the same command line
+static void CompareSchema( CommandLine& commandLine, yaap::Parser& parser )
+{
+    int argc = commandLine.Argc();
+    char** argv = commandLine.Argv();
+    bool delimited;
+    if( !IsOrdered( argc, argv, delimited ) )
+        return;
+    FuzzSchema::Result result;
+    FuzzSchema::Parse( argc, argv, result );
+    const bool exists[] = { result.Exists<Verbose>(), result.Exists<Quiet>(), result.Exists<Output>(),
+                            result.Exists<Number>(), result.Exists<List>(), result.Exists<Ids>() };
+    const bool errors[] = { result.ErrorFlag<Verbose>(), result.ErrorFlag<Quiet>(), result.ErrorFlag<Output>(),
+                            result.ErrorFlag<Number>(), result.ErrorFlag<List>(), result.ErrorFlag<Ids>() };
+    const char* const names[] = { "verbose", "quiet", "output", "number", "list", "ids" };
+    bool valid = true;
+    for( unsigned int k = 0; k < 6; k++ )
+    {
+        yaap::Option* option = parser.GetOption( std::string( names[k] ) );
+        if( option->Exists() != exists[k] )
+            Fail( commandLine, "schema existence", names[k] );
+        if( option->ErrorFlag() != errors[k] )
+            Fail( commandLine, "schema error flag", names[k] );
+        valid = valid && !errors[k];
+    }
+    if( valid != parser.IsCommandLineValid() )
+        Fail( commandLine, "schema validity", "" );
+    // a repeated option keeps the arguments of its last occurrence
+    yaap::OptionArg<std::string>* output = static_cast<yaap::OptionArg<std::string>*>( parser.GetOption( 'o' ) );
+    if( output->Exists() && !output->ErrorFlag()
+     && output->GetOccurrenceArgument( output->GetNumberOfOccurrences() - 1, 0 ) != result.Get<Output>() )
+        Fail( commandLine, "schema argument", "output" );
+    yaap::OptionArg<int>* number = static_cast<yaap::OptionArg<int>*>( parser.GetOption( 'n' ) );
+    if( number->Exists() && !number->ErrorFlag() )
+        for( unsigned int pos = 0; pos < 2; pos++ )
+            if( number->GetOccurrenceArgument( number->GetNumberOfOccurrences() - 1, pos ) != result.Get<Number>()[pos] )
+                Fail( commandLine, "schema argument", "number" );
+    // the lists of all the occurrences follow each other
+    yaap::OptionArg<std::string>* list = static_cast<yaap::OptionArg<std::string>*>( parser.GetOption( 'l' ) );
+    if( !list->ErrorFlag() )
+    {
+        if( list->GetNumberOfArguments() != result.Get<List>().size() )
+            Fail( commandLine, "schema number of arguments", "list" );
+        for( unsigned int pos = 0; pos < list->GetNumberOfArguments(); pos++ )
+            if( list->GetArgument( pos ) != result.Get<List>()[pos] )
+                Fail( commandLine, "schema argument", "list" );
+    }
+    yaap::OptionArg<int>* ids = static_cast<yaap::OptionArg<int>*>( parser.GetOption( 'i' ) );
+    if( !ids->ErrorFlag() )
+    {
+        if( ids->GetNumberOfArguments() != result.Get<Ids>().size() )
+            Fail( commandLine, "schema number of arguments", "ids" );
+        for( unsigned int pos = 0; pos < ids->GetNumberOfArguments(); pos++ )
+            if( ids->GetArgument( pos ) != result.Get<Ids>()[pos] )
+                Fail( commandLine, "schema argument", "ids" );
+    }
+    // both start the operands after "--"; without it, Parser takes them from argv[1]
+    if( delimited && parser.Operands<std::string>().size() != static_cast<std::size_t>( argc - result.OperandOffset() ) )
+        Fail( commandLine, "schema operands", "" );
+}
+#endif
+
+//! Parse the command line with the three parsers and compare them
+static void Run( CommandLine& commandLine )
+{
+    int argc = commandLine.Argc();
+    char** argv = commandLine.Argv();
+    // the completion requests do not parse the command line as given
+    if( argc >= 2 && std::strncmp( argv[1], "--yaap-", 7 ) == 0 )
+        return;
+
+    yaap::Parser parser( argc, argv, "Fuzzed command line" );
+    yaap::Layout layout( "Fuzzed command line" );
+    Reference reference( argc, argv );
+
+    parser.AddOption( 'v', "verbose", "Verbose output" );
+    layout.AddOption( 'v', "verbose", "Verbose output" );
+    reference.AddOption( 'v', "verbose" );
+    parser.AddOption( 'q', "quiet", "Quiet output" );
+    layout.AddOption( 'q', "quiet", "Quiet output" );
+    reference.AddOption( 'q', "quiet" );
+    parser.AddOption( '\0', "dry-run", "Do nothing" );
+    layout.AddOption( '\0', "dry-run", "Do nothing" );
+    reference.AddOption( '\0', "dry-run" );
+    parser.AddOptionArg<std::string>( 'o', "output", "Output file", 1 );
+    layout.AddOptionArg<std::string>( 'o', "output", "Output file", 1 );
+    reference.AddOptionArg( 'o', "output", 1, false );
+    parser.AddOptionArg<int>( 'n', "number", "Two numbers", 2 );
+    layout.AddOptionArg<int>( 'n', "number", "Two numbers", 2 );
+    reference.AddOptionArg( 'n', "number", 2, true );
+    parser.AddOptionArg<std::string>( 'l', "list", "List of names", yaap::undef );
+    layout.AddOptionArg<std::string>( 'l', "list", "List of names", yaap::undef );
+    reference.AddOptionArg( 'l', "list", yaap::undef, false );
+    parser.AddOptionArg<int>( 'i', "ids", "List of identifiers", yaap::undef );
+    layout.AddOptionArg<int>( 'i', "ids", "List of identifiers", yaap::undef );
+    reference.AddOptionArg( 'i', "ids", yaap::undef, true );
+    unsigned int nbOptions = 7;
+
+    yaap::ParseResult result;
+    layout.Parse( argc, argv, result );
+    parser.Validate();
+
+    for( unsigned int id = 0; id < nbOptions; id++ )
+    {
+        const Reference::Option& expected = reference.GetOption( id );
+        yaap::Option* option = parser.GetOption( expected.longName );
+        if( option->Count() != expected.count || result.Count( id ) != expected.count )
+            Fail( commandLine, "count", expected.longName );
+        if( option->Exists() != ( expected.count != 0 ) || result.Exists( id ) != option->Exists() )
+            Fail( commandLine, "existence", expected.longName );
+        // the reference cannot tell about the values it does not convert as yaap
+        bool decided = expected.error || !expected.extension;
+        if( result.ErrorFlag( id ) != option->ErrorFlag() || ( decided && option->ErrorFlag() != expected.error ) )
+            Fail( commandLine, "error flag", expected.longName );
+    }
+    CompareArguments<std::string>( commandLine, parser, result, reference, 3 );
+    CompareArguments<int>( commandLine, parser, result, reference, 4 );
+    CompareArguments<std::string>( commandLine, parser, result, reference, 5 );
+    CompareArguments<int>( commandLine, parser, result, reference, 6 );
+    CompareConversions( commandLine, result, reference, 4 );
+    CompareConversions( commandLine, result, reference, 6 );
+    if( parser.Operands<std::string>().size() != result.Operands<std::string>().size() )
+        Fail( commandLine, "number of operands", "" );
+    if( parser.IsCommandLineValid() != result.IsCommandLineValid() )
+        Fail( commandLine, "validity", "" );
+
+    // the serialized copy tells the same
+    std::string blob;
+    parser.Serialize( blob );
+    yaap::ResultView view;
+    if( !view.Attach( blob.data(), blob.size() ) )
+        Fail( commandLine, "serialized blob", "" );
+    for( unsigned int id = 0; id < nbOptions; id++ )
+        if( view.Exists( id ) != result.Exists( id ) || view.ErrorFlag( id ) != result.ErrorFlag( id )
+         || ( id >= 3 && view.GetNumberOfArguments( id ) != result.GetNumberOfArguments( id ) ) )
+            Fail( commandLine, "serialized option", reference.GetOption( id ).longName );
+    CompareSerialized<std::string>( commandLine, parser, view, reference, 3 );
+    CompareSerialized<int>( commandLine, parser, view, reference, 4 );
+    CompareSerialized<std::string>( commandLine, parser, view, reference, 5 );
+    CompareSerialized<int>( commandLine, parser, view, reference, 6 );
+    yaap::OperandRange<std::string> operands = parser.Operands<std::string>();
+    if( view.IsCommandLineValid() != parser.IsCommandLineValid()
+     || view.GetNumberOfOperands() != 0 || view.GetNumberOfRemainingOperands() != operands.size() )
+        Fail( commandLine, "serialized operands", "" );
+    unsigned int k = 0;
+    for( yaap::OperandRange<std::string>::iterator it = operands.begin(); it != operands.end(); ++it, k++ )
+        if( *it != view.GetRemainingOperand( k ) )
+            Fail( commandLine, "serialized operand", "" );
+
+    // and the usage text can be rendered
+    if( parser.GetUsage().empty() )
+        Fail( commandLine, "usage", "" );
+
+#ifdef YAAP_HAS_CXX17
+    CompareSchema( commandLine, parser );
+#endif
+
+    CompareEditions( commandLine );
+    CompareLazyConversion( commandLine );
+}
+
+extern "C" int LLVMFuzzerTestOneInput( const unsigned char* data, std::size_t size )
+{
+    CommandLine commandLine( reinterpret_cast<const char*>( data ), size );
+    Run( commandLine );
+    return( 0 );
+}
+
+#ifndef YAAP_LIBFUZZER
+//! Tokens of the random command lines: options of the layout, clusters,
+//! unknown options, "--", and good and bad values
+static const char* const tokens[] = {
+    "-v", "-q", "-vq", "-qvv", "-o", "-n", "-l", "-i", "-ov", "-vo", "-nq", "-x", "-", "--", "---",
+    "--verbose", "--quiet", "--dry-run", "--output", "--number", "--list", "--ids", "--unknown",
+    "", "file", "1", "-1", "+2", "007", "2147483648", "-2147483649", "0x1f", "0b101", "1e3", " 4",
+    "a,b", "a,,b", "a,", ",", "1,2,3", "1,x,3", "@file", "-v-q", "--verbose=1"
+};
+
+//! xorshift generator, the same sequence on every platform
+static unsigned int Random( unsigned int& state )
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return( state );
+}
+
+int main( int argc, char** argv )
+{
+    unsigned int runs = 10000;
+    unsigned int seed = 1;
+    std::vector<std::string> files;
+    for( int k = 1; k < argc; k++ )
+    {
+        if( std::strcmp( argv[k], "-runs" ) == 0 && k + 1 < argc )
+            runs = static_cast<unsigned int>( std::strtoul( argv[++k], NULL, 10 ) );
+        else if( std::strcmp( argv[k], "-seed" ) == 0 && k + 1 < argc )
+            seed = static_cast<unsigned int>( std::strtoul( argv[++k], NULL, 10 ) );
+        else
+            files.push_back( argv[k] );
+    }
+
+    for( std::size_t k = 0; k < files.size(); k++ )
+    {
+        std::ifstream file( files[k].c_str(), std::ios::binary );
+        if( !file )
+        {
+            std::fprintf( stderr, "fuzzyaap: cannot read %s\n", files[k].c_str() );
+            return( 1 );
+        }
+        std::string data( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+        LLVMFuzzerTestOneInput( reinterpret_cast<const unsigned char*>( data.data() ), data.size() );
+    }
+    if( !files.empty() )
+        return( 0 );
+
+    unsigned int state = seed != 0 ? seed : 1;
+    const unsigned int nbTokens = sizeof( tokens ) / sizeof( tokens[0] );
+    for( unsigned int run = 0; run < runs; run++ )
+    {
+        std::string data;
+        unsigned int nbArgs = Random( state ) % 12;
+        for( unsigned int k = 0; k < nbArgs; k++ )
+        {
+            if( k > 0 )
+                data += '\0';
+            data += tokens[Random( state ) % nbTokens];
+        }
+        LLVMFuzzerTestOneInput( reinterpret_cast<const unsigned char*>( data.data() ), data.size() );
+    }
+    std::printf( "fuzzyaap: %u command lines, no difference\n", runs );
+    return( 0 );
+}
+#endif
@@ -0,0 +1,39 @@
+//! \file yaap.cppm
+//! \brief C++20 module interface of yaap
+//!
+//! Built with the YAAP_BUILD_MODULE CMake option (CMake 3.28 or later),
+//! then used with
+//!   import yaap;
+//! instead of including yaap.h. The macros of yaap.h (YAAP_NO_SIMD, ...)
+//! apply when the module is built, not where it is imported.
+
+module;
+
+#include "yaap.h"
+
+export module yaap;
+
+export namespace yaap {
+    using yaap::undef;
+    using yaap::Converter;
+    using yaap::EnumName;
+    using yaap::EnumConverter;
+    using yaap::Ipv4Address;
+    using yaap::ByteSize;
+    using yaap::Span;
+    using yaap::Option;
+    using yaap::OptionArg;
+    using yaap::OperandBase;
+    using yaap::Operand;
+    using yaap::OperandRange;
+    using yaap::OptionIndex;
+    using yaap::Error;
+    using yaap::ErrorBuffer;
+    using yaap::ParserStats;
+    using yaap::Parser;
+    using yaap::ResultView;
+    using yaap::ParseResult;
+    using yaap::Layout;
+    using yaap::Field;
+    using yaap::Schema;
+}
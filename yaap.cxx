@@ -0,0 +1,15 @@
+//! \file yaap.cxx
+//! \brief Instantiations of the yaap library target
+//!
+//! Compiled into the yaap library (YAAP_BUILD_LIBRARY CMake option). The
+//! translation units linked with it see the extern template declarations of
+//! yaap.h and use these instantiations instead of their own.
+
+#define YAAP_INSTANTIATE_TEMPLATES
+#include "yaap.h"
+
+namespace yaap {
+
+YAAP_INSTANTIATE_ALL( )
+
+} // namespace yaap
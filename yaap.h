@@ -29,16 +29,799 @@
 #ifndef __yaap_h__
 #define __yaap_h__
 
+// Define YAAP_NO_IOSTREAM for a header that does not include <iostream>: the
+// std::ostream overloads of Usage() are left out and Converter<T> is only
+// defined for the types listed below (others must be specialized).
+#ifndef YAAP_NO_IOSTREAM
 #include <iostream>
 #include <sstream>
+#endif
 #include <vector>
 #include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdlib>
+#include <cerrno>
+#include <cctype>
+#include <limits>
+#include <new>
+#include <iterator>
+#include <cstdio>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#define YAAP_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+extern "C" char** environ;
+// nanoseconds of the modification and status change times of a struct stat
+#ifdef __APPLE__
+#define YAAP_MTIME_NSEC( status ) ( status ).st_mtimespec.tv_nsec
+#define YAAP_CTIME_NSEC( status ) ( status ).st_ctimespec.tv_nsec
+#else
+#define YAAP_MTIME_NSEC( status ) ( status ).st_mtim.tv_nsec
+#define YAAP_CTIME_NSEC( status ) ( status ).st_ctim.tv_nsec
+#endif
+#endif
+#include <algorithm>
+#include <functional>
+
+#if !defined( YAAP_NO_SIMD ) && defined( __GNUC__ )
+#if defined( __SSE2__ )
+#define YAAP_HAS_SSE2 1
+#include <emmintrin.h>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define YAAP_HAS_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+#elif defined( __aarch64__ ) && defined( __ARM_NEON )
+#define YAAP_HAS_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+#if __cplusplus >= 201103L
+#include <array>
+#include <chrono>
+#include <type_traits>
+#endif
+
+#if __cplusplus >= 202002L && defined( __has_include )
+#if __has_include( <span> )
+#define YAAP_HAS_CXX20 1
+#include <span>
+#endif
+#endif
+
+#if __cplusplus >= 201703L
+#define YAAP_HAS_CXX17 1
+#define YAAP_CACHE_ALIGNED alignas( 64 )
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#else
+#define YAAP_CACHE_ALIGNED
+#endif
+
+// Parser::Prefetch() reads the argument files in background threads;
+// define YAAP_NO_THREADS to leave it out
+#if __cplusplus >= 201103L && !defined( YAAP_NO_THREADS )
+#define YAAP_HAS_THREADS 1
+#include <chrono>
+#include <future>
+#include <system_error>
+#endif
+
+// Define YAAP_ENABLE_STATS to fill Parser::Stats() (see ParserStats)
+#ifdef YAAP_ENABLE_STATS
+#define YAAP_STATS( statement ) statement
+#if __cplusplus >= 201103L
+#include <chrono>
+#else
+#include <ctime>
+#endif
+#else
+#define YAAP_STATS( statement )
+#endif
 
 //! \namespace yaap contains the classes for command line arguments parsing
 namespace yaap {
 
 const int undef = 0;
 
+//! \struct Converter
+//! \brief Conversion of a command line string into a value of type T
+//!
+//! Convert() reads the characters [first, last) into value and returns a
+//! pointer past the last character used: the conversion succeeded if it
+//! returns last, otherwise it points at the offending character.
+//! Integral and floating point types are converted without streams nor
+//! allocation. Other types fall back on their operator>>.
+//!
+//! Converter is the customization point of the user types: specialize it,
+//! in namespace yaap, for a type the parser should read without a stream.
+//! The stop pointer is reported by Parser::Errors() as the offset of an
+//! Error::BadValue (Error::BadOperand for an operand), so that a converter
+//! rejecting the unit of "12kg" points at 'k'. The library gives
+//! converters of std::chrono::duration ("500ms"), ByteSize ("4GiB"),
+//! Ipv4Address and, through EnumConverter, of enumerations by name.
+#ifndef YAAP_NO_IOSTREAM
+template<typename T>
+struct Converter {
+    static const char* Convert( const char* first, const char* last, T& value )
+    {
+        std::istringstream stream( std::string( first, last ) );
+        stream >> value;
+        if( stream.fail() )
+            return( first );
+        if( stream.eof() )
+            return( last );
+        return( first + static_cast<std::ptrdiff_t>( stream.tellg() ) );
+    };
+};
+#else
+template<typename T>
+struct Converter;
+#endif
+
+//! Whole argument, white spaces included
+template<>
+struct Converter<std::string> {
+    static const char* Convert( const char* first, const char* last, std::string& value )
+    {
+        value.assign( first, last );
+        return( last );
+    };
+};
+
+#ifdef YAAP_HAS_CXX17
+//! Zero-copy view into argv, white spaces included. The parser does not copy
+//! argv: the view is valid as long as argv is, that is for the whole process
+//! when argv comes from main(), or as long as the Parser for arguments read
+//! from response files.
+template<>
+struct Converter<std::string_view> {
+    static const char* Convert( const char* first, const char* last, std::string_view& value )
+    {
+        value = std::string_view( first, static_cast<std::size_t>( last - first ) );
+        return( last );
+    };
+};
+#endif
+
+//! \struct IntegerConverter
+//! \brief Converter of integral types
+//!
+//! Accepts an optional sign (for signed types) and a base prefix: '0x' for
+//! hexadecimal, '0o' for octal and '0b' for binary. Out of range values are
+//! rejected at the digit that overflows.
+template<typename T>
+struct IntegerConverter {
+#if __cplusplus >= 201103L
+    typedef unsigned long long Magnitude;
+#else
+    typedef unsigned long Magnitude;
+#endif
+
+    static const char* Convert( const char* first, const char* last, T& value )
+    {
+        const char* p = first;
+        bool negative = false;
+        if( p != last && ( *p == '-' || *p == '+' ) )
+        {
+            negative = ( *p == '-' );
+            if( negative && !std::numeric_limits<T>::is_signed )
+                return( first );
+            p++;
+        }
+        unsigned int base = 10;
+        if( last - p > 2 && p[0] == '0' )
+        {
+            if( p[1] == 'x' || p[1] == 'X' )
+                base = 16;
+            else if( p[1] == 'o' || p[1] == 'O' )
+                base = 8;
+            else if( p[1] == 'b' || p[1] == 'B' )
+                base = 2;
+            if( base != 10 )
+                p += 2;
+        }
+        Magnitude limit = static_cast<Magnitude>( std::numeric_limits<T>::max() );
+        if( negative )
+            limit++;
+        Magnitude magnitude = 0;
+        const char* digits = p;
+        for( ; p != last; p++ )
+        {
+            unsigned int digit;
+            if( *p >= '0' && *p <= '9' )
+                digit = *p - '0';
+            else if( *p >= 'a' && *p <= 'z' )
+                digit = *p - 'a' + 10;
+            else if( *p >= 'A' && *p <= 'Z' )
+                digit = *p - 'A' + 10;
+            else
+                break;
+            if( digit >= base )
+                break;
+            if( magnitude > ( limit - digit ) / base ) // out of range
+                return( p );
+            magnitude = magnitude * base + digit;
+        }
+        if( p == digits ) // no digit
+            return( p );
+        if( negative && magnitude != 0 )
+            value = static_cast<T>( -static_cast<T>( magnitude - 1 ) - 1 );
+        else
+            value = static_cast<T>( magnitude );
+        return( p );
+    };
+};
+
+template<> struct Converter<short> : IntegerConverter<short> {};
+template<> struct Converter<unsigned short> : IntegerConverter<unsigned short> {};
+template<> struct Converter<int> : IntegerConverter<int> {};
+template<> struct Converter<unsigned int> : IntegerConverter<unsigned int> {};
+template<> struct Converter<long> : IntegerConverter<long> {};
+template<> struct Converter<unsigned long> : IntegerConverter<unsigned long> {};
+#if __cplusplus >= 201103L
+template<> struct Converter<long long> : IntegerConverter<long long> {};
+template<> struct Converter<unsigned long long> : IntegerConverter<unsigned long long> {};
+#endif
+
+//! \struct FloatConverter
+//! \brief Converter of floating point types, based on strtod
+template<typename T>
+struct FloatConverter {
+    static const char* Convert( const char* first, const char* last, T& value )
+    {
+        // strtod needs a null-terminated string: copy short arguments on the
+        // stack, which also bounds the read to [first, last)
+        char buffer[64];
+        std::string heap;
+        const char* str = buffer;
+        std::size_t length = static_cast<std::size_t>( last - first );
+        if( length < sizeof( buffer ) )
+        {
+            std::memcpy( buffer, first, length );
+            buffer[length] = '\0';
+        }
+        else
+        {
+            heap.assign( first, last );
+            str = heap.c_str();
+        }
+        if( length == 0 || std::isspace( static_cast<unsigned char>( str[0] ) ) )
+            return( first );
+        char* end;
+        errno = 0;
+        T v = Parse( str, &end );
+        if( end == str )
+            return( first );
+        if( errno == ERANGE && ( v > 1 || v < -1 ) ) // overflow, not underflow
+            return( first );
+        value = v;
+        return( first + ( end - str ) );
+    };
+
+private:
+    static T Parse( const char* str, char** end );
+};
+
+template<> inline double FloatConverter<double>::Parse( const char* str, char** end ) {
+    return( std::strtod( str, end ) );
+}
+#if __cplusplus >= 201103L
+template<> inline float FloatConverter<float>::Parse( const char* str, char** end ) {
+    return( std::strtof( str, end ) );
+}
+template<> inline long double FloatConverter<long double>::Parse( const char* str, char** end ) {
+    return( std::strtold( str, end ) );
+}
+#else
+template<> inline float FloatConverter<float>::Parse( const char* str, char** end ) {
+    return( static_cast<float>( std::strtod( str, end ) ) );
+}
+#endif
+
+template<> struct Converter<double> : FloatConverter<double> {};
+template<> struct Converter<float> : FloatConverter<float> {};
+#if __cplusplus >= 201103L
+template<> struct Converter<long double> : FloatConverter<long double> {};
+#endif
+
+namespace detail {
+
+//! Read the decimal digits at the start of [first, last) into value, up to
+//! max. \return a pointer past the last digit, at the digit that overflows,
+//! or first if there is no digit
+template<typename T>
+inline const char* ParseDecimal( const char* first, const char* last, T max, T& value )
+{
+    T n = 0;
+    const char* p = first;
+    for( ; p != last && *p >= '0' && *p <= '9'; p++ )
+    {
+        T digit = static_cast<T>( *p - '0' );
+        if( n > ( max - digit ) / 10 )
+            return( p );
+        n = static_cast<T>( n * 10 + digit );
+    }
+    value = n;
+    return( p );
+}
+
+inline bool IsDigit( const char* p, const char* last )
+{
+    return( p != last && *p >= '0' && *p <= '9' );
+}
+
+} // namespace detail
+
+//! \struct EnumName
+//! \brief Name of a value of an enumeration, see EnumConverter
+template<typename T>
+struct EnumName {
+    const char* name; //!< name in the command line, NULL at the end of a table
+    T value; //!< value of the name
+};
+
+//! \struct EnumConverter
+//! \brief Converter of an enumeration from the names of its values
+//!
+//! The argument must be one of the names, as a whole. Converter<T> derives
+//! from it and gives the table of the names, ended by a NULL name:
+//!    namespace yaap {
+//!    template<> struct Converter<Color> : EnumConverter<Color> {
+//!        static const EnumName<Color>* Names( ) {
+//!            static const EnumName<Color> names[] = { { "red", Red }, { "blue", Blue }, { NULL, Red } };
+//!            return( names );
+//!        };
+//!    };
+//!    }
+template<typename T>
+struct EnumConverter {
+    static const char* Convert( const char* first, const char* last, T& value )
+    {
+        std::size_t length = static_cast<std::size_t>( last - first );
+        for( const EnumName<T>* entry = Converter<T>::Names(); entry->name != NULL; entry++ )
+            if( std::strncmp( entry->name, first, length ) == 0 && entry->name[length] == '\0' )
+            {
+                value = entry->value;
+                return( last );
+            }
+        return( first );
+    };
+};
+
+//! \struct Ipv4Address
+//! \brief IPv4 address in dotted-decimal notation, e.g. "192.168.0.1"
+struct Ipv4Address {
+    Ipv4Address( ) {
+        this->octets[0] = this->octets[1] = this->octets[2] = this->octets[3] = 0;
+    };
+
+    //! Address as a 32-bit number in host order
+    unsigned long Value( ) const {
+        return( ( static_cast<unsigned long>( this->octets[0] ) << 24 ) | ( static_cast<unsigned long>( this->octets[1] ) << 16 )
+                | ( static_cast<unsigned long>( this->octets[2] ) << 8 ) | this->octets[3] );
+    };
+
+    bool operator<( const Ipv4Address& other ) const {
+        return( this->Value() < other.Value() );
+    };
+
+    bool operator==( const Ipv4Address& other ) const {
+        return( this->Value() == other.Value() );
+    };
+
+    unsigned char octets[4]; //!< in network order: octets[0] is written first
+};
+
+//! Four decimal numbers from 0 to 255 without leading zero, separated by dots
+template<>
+struct Converter<Ipv4Address> {
+    static const char* Convert( const char* first, const char* last, Ipv4Address& value )
+    {
+        Ipv4Address address;
+        const char* p = first;
+        for( int k = 0; k < 4; k++ )
+        {
+            if( k > 0 )
+            {
+                if( p == last ) // too few numbers
+                    return( first );
+                if( *p != '.' )
+                    return( p );
+                p++;
+            }
+            unsigned int octet = 0;
+            const char* end = detail::ParseDecimal( p, last, 255u, octet );
+            if( end == p || ( end - p > 1 && *p == '0' ) )
+                return( p == last ? first : p );
+            if( detail::IsDigit( end, last ) ) // above 255
+                return( end );
+            address.octets[k] = static_cast<unsigned char>( octet );
+            p = end;
+        }
+        value = address;
+        return( p );
+    };
+};
+
+#if __cplusplus >= 201103L
+namespace detail {
+
+//! Unit suffix of a quantity, worth num / den of its base unit
+struct Unit {
+    const char* name; //!< suffix, NULL at the end of a table
+    unsigned long long num;
+    unsigned long long den;
+};
+
+//! \return the unit named [first, last) in units, NULL if none
+inline const Unit* FindUnit( const Unit* units, const char* first, const char* last )
+{
+    std::size_t length = static_cast<std::size_t>( last - first );
+    for( ; units->name != NULL; units++ )
+        if( std::strncmp( units->name, first, length ) == 0 && units->name[length] == '\0' )
+            return( units );
+    return( NULL );
+}
+
+//! product = a * b. \return false on overflow
+inline bool Multiply( unsigned long long a, unsigned long long b, unsigned long long& product )
+{
+    if( b != 0 && a > std::numeric_limits<unsigned long long>::max() / b )
+        return( false );
+    product = a * b;
+    return( true );
+}
+
+inline unsigned long long Gcd( unsigned long long a, unsigned long long b )
+{
+    while( b != 0 )
+    {
+        unsigned long long r = a % b;
+        a = b;
+        b = r;
+    }
+    return( a );
+}
+
+} // namespace detail
+
+//! \struct ByteSize
+//! \brief Number of bytes, e.g. "4GiB", "512K" or "1500"
+struct ByteSize {
+    ByteSize( unsigned long long bytes = 0 ) : bytes( bytes ) {};
+
+    bool operator<( const ByteSize& other ) const {
+        return( this->bytes < other.bytes );
+    };
+
+    bool operator==( const ByteSize& other ) const {
+        return( this->bytes == other.bytes );
+    };
+
+    unsigned long long bytes; //!< size in bytes
+};
+
+//! A decimal number followed by an optional unit, as for GNU dd: B (byte),
+//! kB, MB, GB, TB, PB and EB (powers of 1000), K (or k), M, G, T, P and E
+//! (powers of 1024), as KiB, MiB, GiB, TiB, PiB and EiB. A size too large
+//! for 64 bits is rejected at its unit.
+template<>
+struct Converter<ByteSize> {
+    static const char* Convert( const char* first, const char* last, ByteSize& value )
+    {
+        static const detail::Unit units[] = {
+            { "", 1, 1 }, { "B", 1, 1 },
+            { "kB", 1000ULL, 1 }, { "MB", 1000000ULL, 1 }, { "GB", 1000000000ULL, 1 },
+            { "TB", 1000000000000ULL, 1 }, { "PB", 1000000000000000ULL, 1 }, { "EB", 1000000000000000000ULL, 1 },
+            { "K", 1ULL << 10, 1 }, { "k", 1ULL << 10, 1 }, { "M", 1ULL << 20, 1 }, { "G", 1ULL << 30, 1 },
+            { "T", 1ULL << 40, 1 }, { "P", 1ULL << 50, 1 }, { "E", 1ULL << 60, 1 },
+            { "KiB", 1ULL << 10, 1 }, { "MiB", 1ULL << 20, 1 }, { "GiB", 1ULL << 30, 1 },
+            { "TiB", 1ULL << 40, 1 }, { "PiB", 1ULL << 50, 1 }, { "EiB", 1ULL << 60, 1 },
+            { NULL, 0, 0 } };
+        unsigned long long count = 0;
+        const char* unit = detail::ParseDecimal( first, last, std::numeric_limits<unsigned long long>::max(), count );
+        if( unit == first || detail::IsDigit( unit, last ) )
+            return( unit );
+        const detail::Unit* scale = detail::FindUnit( units, unit, last );
+        unsigned long long bytes;
+        if( scale == NULL || !detail::Multiply( count, scale->num, bytes ) )
+            return( unit );
+        value.bytes = bytes;
+        return( last );
+    };
+};
+
+//! A number followed by a unit: ns, us, ms, s, min, h or d, e.g. "500ms".
+//! A duration with integral ticks takes a decimal number, rejected at its
+//! unit if it is not a whole number of ticks ("1ns" in std::chrono::seconds)
+//! or does not fit; with floating point ticks, the number may be fractional
+//! ("1.5s").
+template<class Rep, class Period>
+struct Converter<std::chrono::duration<Rep, Period> > {
+    typedef std::chrono::duration<Rep, Period> Duration;
+
+    static const char* Convert( const char* first, const char* last, Duration& value )
+    {
+        return( Convert( first, last, value, std::chrono::treat_as_floating_point<Rep>() ) );
+    };
+
+private:
+    static const char* Convert( const char* first, const char* last, Duration& value, std::false_type )
+    {
+        unsigned long long count = 0;
+        const char* unit = detail::ParseDecimal( first, last, std::numeric_limits<unsigned long long>::max(), count );
+        if( unit == first || detail::IsDigit( unit, last ) )
+            return( unit );
+        if( unit == last ) // no unit
+            return( first );
+        unsigned long long num, den, ticks;
+        if( !Ratio( unit, last, num, den ) || !detail::Multiply( count, num, ticks ) || ticks % den != 0 )
+            return( unit );
+        ticks /= den;
+        if( ticks > static_cast<unsigned long long>( std::numeric_limits<Rep>::max() ) )
+            return( unit );
+        value = Duration( static_cast<Rep>( ticks ) );
+        return( last );
+    };
+
+    static const char* Convert( const char* first, const char* last, Duration& value, std::true_type )
+    {
+        if( first == last || !( detail::IsDigit( first, last ) || *first == '.' ) )
+            return( first );
+        Rep count = 0;
+        const char* unit = Converter<Rep>::Convert( first, last, count );
+        if( unit == last ) // no unit
+            return( first );
+        unsigned long long num, den;
+        if( unit == first || !Ratio( unit, last, num, den ) )
+            return( unit );
+        value = Duration( count * static_cast<Rep>( num ) / static_cast<Rep>( den ) );
+        return( last );
+    };
+
+    //! Ticks of Period in the unit [first, last), as num / den.
+    //! \return false if the unit is unknown or the ratio too large
+    static bool Ratio( const char* first, const char* last, unsigned long long& num, unsigned long long& den )
+    {
+        static const detail::Unit units[] = {
+            { "ns", 1, 1000000000ULL }, { "us", 1, 1000000ULL }, { "ms", 1, 1000ULL }, { "s", 1, 1 },
+            { "min", 60, 1 }, { "h", 3600, 1 }, { "d", 86400, 1 }, { NULL, 0, 0 } };
+        const detail::Unit* unit = detail::FindUnit( units, first, last );
+        if( unit == NULL )
+            return( false );
+        // ( unit->num / unit->den ) / ( Period::num / Period::den ), reduced
+        unsigned long long a = unit->num, b = unit->den;
+        unsigned long long c = static_cast<unsigned long long>( Period::den );
+        unsigned long long d = static_cast<unsigned long long>( Period::num );
+        unsigned long long g = detail::Gcd( a, d );
+        a /= g;
+        d /= g;
+        g = detail::Gcd( c, b );
+        c /= g;
+        b /= g;
+        return( detail::Multiply( a, c, num ) && detail::Multiply( b, d, den ) );
+    };
+};
+#endif
+
+namespace detail {
+
+//! \name Usage rendering
+//! Usage texts are rendered in a std::string, then written at once.
+//! \{
+
+inline void AppendNumber( std::string& out, unsigned int n )
+{
+    char digits[16];
+    int k = 0;
+    do
+    {
+        digits[k++] = static_cast<char>( '0' + n % 10 );
+        n /= 10;
+    } while( n != 0 );
+    while( k > 0 )
+        out += digits[--k];
+}
+
+//! Names of an option, "-s/--spacing", or "--spacing" for a '\0' flag
+inline void AppendOptionNames( std::string& out, char flag, const char* longName )
+{
+    if( flag != '\0' )
+    {
+        ( out += '-' ) += flag;
+        if( longName[0] != '\0' )
+            out += '/';
+    }
+    if( longName[0] != '\0' )
+        ( out += "--" ) += longName;
+}
+
+//! Command line format of an option, e.g. " [-s/--spacing x1 x2 x3]"
+inline void AppendOptionSynopsis( std::string& out, char flag, const char* longName, bool hasArgs, unsigned int nbArgs )
+{
+    out += " [";
+    AppendOptionNames( out, flag, longName );
+    if( hasArgs )
+    {
+        if( nbArgs == yaap::undef )
+            out += " x1,x2,...";
+        else
+            for( unsigned int i = 0; i < nbArgs; i++ )
+            {
+                out += " x";
+                if( nbArgs > 1 )
+                    AppendNumber( out, i + 1 );
+            }
+    }
+    out += ']';
+}
+
+//! Up to the utility name on the usage line; the synopsis follows
+inline void AppendUsageHeader( std::string& out, const char* program, const char* description )
+{
+    ( ( out += "\nUtility " ) += program ) += " :\n";
+    ( ( out += '\n' ) += description ) += '\n';
+    ( out += "\nUsage: \n [shell]$ " ) += program;
+}
+
+//! Description line of an option, marked with a '*' if error is true
+inline void AppendOptionLine( std::string& out, bool error, char flag, const char* longName,
+                              const char* description, bool required )
+{
+    out += error ? "     *\t" : "\t";
+    AppendOptionNames( out, flag, longName );
+    ( out += " : " ) += description;
+    out += required ? " (Required).\n" : " (Optional).\n";
+}
+
+inline void AppendUsageFooter( std::string& out )
+{
+    out += "* indicate(s) wrong argument(s).\n";
+}
+
+//! \}
+
+} // namespace detail
+
+namespace detail {
+
+//! \name Result blobs
+//! A blob is a flat copy of the state of a Parser (see Parser::Serialize()
+//! and ResultView). Every position in it is an offset from its first byte,
+//! so that it can be written to a pipe or a shared memory and read in place.
+//! \{
+
+//! Kind of the values of a BlobRecord
+enum BlobKind { OpaqueBlob, SignedBlob, UnsignedBlob, FloatBlob, StringBlob };
+
+//! Description of an option or of an operand in a blob
+struct BlobRecord {
+    unsigned int name; //!< offset of the long name (the description of an operand)
+    unsigned int values; //!< offset of the values
+    unsigned int count; //!< number of values
+    unsigned int elementSize; //!< size of a value
+    unsigned char kind; //!< BlobKind of the values; OpaqueBlob values are not stored
+    char flag; //!< flag of the option, '\0' for an operand
+    unsigned char exists; //!< 1 if present in the command line
+    unsigned char error; //!< 1 if wrong
+};
+
+//! Header of a blob, followed by the records of the options then of the
+//! operands, the offsets of the operand strings, and the data
+struct BlobHeader {
+    char magic[8]; //!< "yaapres1"
+    unsigned int size; //!< size of the blob
+    unsigned int nbOptions; //!< number of option records
+    unsigned int nbOperands; //!< number of operand records
+    unsigned int nbArguments; //!< number of operand strings
+    unsigned int arguments; //!< offset of the offsets of the operand strings
+    unsigned int valid; //!< 1 if the command line is valid
+};
+
+inline const char* BlobMagic( ) {
+    return( "yaapres1" );
+}
+
+//! Pad blob to a multiple of 8 bytes. \return its new size
+inline unsigned int AlignBlob( std::string& blob )
+{
+    blob.append( ( 8 - blob.size() % 8 ) % 8, '\0' );
+    return( static_cast<unsigned int>( blob.size() ) );
+}
+
+//! Append a null-terminated copy of string. \return its offset
+inline unsigned int AppendBlobString( std::string& blob, const char* string )
+{
+    unsigned int offset = static_cast<unsigned int>( blob.size() );
+    blob.append( string, std::strlen( string ) + 1 );
+    return( offset );
+}
+
+//! Write and read the values of type T in a blob. Arithmetic values are
+//! copied as they are; other types are not stored, but for std::string.
+template<typename T>
+struct BlobCodec {
+    static unsigned char Kind( )
+    {
+        if( !std::numeric_limits<T>::is_specialized )
+            return( OpaqueBlob );
+        if( !std::numeric_limits<T>::is_integer )
+            return( FloatBlob );
+        return( std::numeric_limits<T>::is_signed ? SignedBlob : UnsignedBlob );
+    };
+
+    //! Reserve room for count values. \return their offset
+    static unsigned int Reserve( std::string& blob, std::size_t count )
+    {
+        unsigned int offset = AlignBlob( blob );
+        if( Kind() != OpaqueBlob )
+            blob.append( count * sizeof( T ), '\0' );
+        return( offset );
+    };
+
+    static void Write( std::string& blob, unsigned int values, std::size_t pos, const T& value )
+    {
+        if( Kind() != OpaqueBlob )
+            std::memcpy( &blob[values + pos * sizeof( T )], &value, sizeof( T ) );
+    };
+
+    static void Read( const char* blob, unsigned int values, std::size_t pos, T& value )
+    {
+        std::memcpy( &value, blob + values + pos * sizeof( T ), sizeof( T ) );
+    };
+};
+
+//! Strings are stored null-terminated, after the offsets of all of them
+template<>
+struct BlobCodec<std::string> {
+    static unsigned char Kind( ) {
+        return( StringBlob );
+    };
+
+    static unsigned int Reserve( std::string& blob, std::size_t count )
+    {
+        unsigned int offset = AlignBlob( blob );
+        blob.append( count * sizeof( unsigned int ), '\0' );
+        return( offset );
+    };
+
+    static void Write( std::string& blob, unsigned int values, std::size_t pos, const std::string& value )
+    {
+        unsigned int offset = static_cast<unsigned int>( blob.size() );
+        blob.append( value.c_str(), value.size() + 1 );
+        std::memcpy( &blob[values + pos * sizeof( unsigned int )], &offset, sizeof( unsigned int ) );
+    };
+
+    static void Read( const char* blob, unsigned int values, std::size_t pos, std::string& value )
+    {
+        unsigned int offset;
+        std::memcpy( &offset, blob + values + pos * sizeof( unsigned int ), sizeof( unsigned int ) );
+        value.assign( blob + offset );
+    };
+};
+
+//! Size of the values of type T in a blob
+template<typename T>
+unsigned int BlobElementSize( )
+{
+    return( BlobCodec<T>::Kind() == StringBlob ? static_cast<unsigned int>( sizeof( unsigned int ) )
+                                               : static_cast<unsigned int>( sizeof( T ) ) );
+}
+
+//! \}
+
+} // namespace detail
+
 //! \class Option
 //! \brief Defines a boolean option
 //!
@@ -56,8 +839,13 @@ public:
         this->state = false;
         this->required = false;
         this->error = false;
+        this->errorPosition = NULL;
+        this->count = 0;
     };
 
+    //! destructor
+    virtual ~Option( ) {};
+
     //! Get the flag of this option.
     char Flag( ) {
         return( this->flag);
@@ -78,6 +866,19 @@ public:
         return(this->state);
     };
 
+    //! Record n more occurrences of the option, and its existence if n > 0
+    void AddOccurrences( unsigned int n ) {
+        this->count += n;
+        if( n > 0 )
+            this->state = true;
+    };
+
+    //! Number of occurrences of the option in the command line: 3 for
+    //! "-vvv" or "-v -v --verbose", 1 for a value taken from a fall-back
+    unsigned int Count( ) const {
+        return( this->count );
+    };
+
     //! Set the requirement level (required is true, optional is false)
     void SetRequired( bool r ) {
         this->required = r;
@@ -88,25 +889,93 @@ public:
         this->error =true;
     };
 
+    //! Set the error flag to true, position being the first command line
+    //! character that could not be converted
+    void RaiseError( const char* position ) {
+        this->error = true;
+        if( this->errorPosition == NULL )
+            this->errorPosition = position;
+    };
+
     //! Get the error state
     bool ErrorFlag() {
         return( this->error );
     };
 
+    //! First command line character that could not be converted, NULL if none
+    const char* ErrorPosition( ) const {
+        return( this->errorPosition );
+    };
+
     bool IsRequired( ) {
         return( this->required );
     };
 
+    //! Perform the checks postponed by lazy conversion, see OptionArg
+    //! \return false if the error flag is raised
+    virtual bool Validate( ) {
+        return( !this->error );
+    };
+
+    //! Append to stops the first wrong character of each argument that
+    //! Validate() failed to convert, in command line order, and forget them,
+    //! so that Parser::Validate() records each failure once
+    virtual void TakeFailures( std::vector<const char*>& stops ) {
+        (void)stops;
+    };
+
+    //! Forget the parsed state (existence, occurrences, error flag and
+    //! values), before the option is parsed again, see Parser::Update()
+    virtual void Reset( )
+    {
+        this->state = false;
+        this->error = false;
+        this->errorPosition = NULL;
+        this->count = 0;
+    };
+
+    //! Result of CheckValues()
+    enum ValueCheck { ValuesOk, ValueOutOfRange, ValueNotAChoice };
+
+    //! Check the converted values against the range or the choices set on
+    //! the option (see OptionArg::SetRange()), raising the error flag if one
+    //! does not match. pos is then the index of the first wrong value.
+    virtual ValueCheck CheckValues( unsigned int& pos ) {
+        pos = 0;
+        return( ValuesOk );
+    };
+
+#ifndef YAAP_NO_IOSTREAM
     //! Print how to use the option in the command line format
-    virtual void CLUsage( )
+    void CLUsage( )
     {
-        std::cout << " [-" << this->Flag() << "/--"<<this->LongName()<<"]";
+        std::string out;
+        this->CLUsage( out );
+        std::cout << out;
+    };
+#endif
+
+    //! Append to out how to use the option in the command line format
+    virtual void CLUsage( std::string& out )
+    {
+        detail::AppendOptionSynopsis( out, this->flag, this->longName.c_str(), false, 0 );
     };
 
     std::string GetDescription( ) {
         return( this->description );
     };
 
+    //! Append the values of the option to blob and describe them in record
+    //! (see Parser::Serialize()). A simple option has no value.
+    virtual void Serialize( std::string& blob, detail::BlobRecord& record )
+    {
+        (void)blob;
+        record.kind = detail::OpaqueBlob;
+        record.values = 0;
+        record.count = 0;
+        record.elementSize = 0;
+    };
+
 protected:
     char flag; //!< Command line flag character
     std::string longName;//!< Command line long name string
@@ -114,405 +983,4362 @@ protected:
     bool state;//!< true if present in the command line
     bool required;//!< if true, the absence of the option in the command line will raise an error in the parser.
     bool error; //!< if true, an error occured while parsing.
+    const char* errorPosition; //!< first character that failed to convert, NULL if none
+    unsigned int count; //!< number of occurrences, see Count()
 };
 
-//! \class OptionArg
-//! \brief Defines an option with possibly several arguments
+//! \struct Error
+//! \brief Record of a command line error
 //!
-//! This is a templated class derived from Option. It adds a vector of
-//! arguments which type and number is defined by the template statements T
-//! and N.
-template<typename T>
+//! Filled while parsing, without allocation, so that a caller can reject a
+//! command line with a precise message without rendering the usage.
+struct Error {
+    enum Code {
+        MissingRequired, //!< a required option is absent
+        MissingArgument, //!< the command line ends before the option-arguments
+        BadValue,        //!< an option-argument does not convert
+        MissingOperand,  //!< the command line ends before the operand
+        BadOperand,      //!< an operand does not convert
+        ReservedFlag,    //!< an option uses the reserved flag 'W' or '-'
+        DuplicateOption, //!< an option reuses the flag or long name of another
+        UnreadableFile,  //!< a response file cannot be read
+        TooManyValues,   //!< more option-arguments than the bound buffer holds
+        OutOfRange,      //!< an option-argument is out of the range of the option
+        InvalidChoice,   //!< an option-argument is not one of the choices of the option
+        MissingDependency, //!< an option is present without one it requires
+        Conflict,        //!< options excluding each other are present together
+        MissingAlternative //!< none of a group of options is present
+    };
+
+    Code code; //!< kind of error
+    unsigned int argIndex; //!< index in argv of the faulty argument, 0 if none or for a fall-back value
+    unsigned int offset; //!< in argv[argIndex] (or the fall-back value), first character that could not be converted
+    unsigned int id; //!< index of the option (in order of addition) or of the operand
+    const Option* option; //!< faulty option, NULL for an operand, a file or a yaap::Layout
+
+    //! Static, null-terminated description of code
+    static const char* Message( Code code )
+    {
+        switch( code )
+        {
+            case MissingRequired: return( "missing required option" );
+            case MissingArgument: return( "missing option-argument" );
+            case BadValue:        return( "invalid option-argument" );
+            case MissingOperand:  return( "missing operand" );
+            case BadOperand:      return( "invalid operand" );
+            case ReservedFlag:    return( "reserved option flag" );
+            case DuplicateOption: return( "duplicate option" );
+            case UnreadableFile:  return( "unreadable response file" );
+            case TooManyValues:   return( "too many option-arguments" );
+            case OutOfRange:      return( "option-argument out of range" );
+            case InvalidChoice:   return( "option-argument is not a valid choice" );
+            case MissingDependency: return( "option requires another option" );
+            case Conflict:        return( "conflicting options" );
+            case MissingAlternative: return( "missing one of the options" );
+        }
+        return( "unknown error" );
+    };
+};
+
+//! \class ErrorBuffer
+//! \brief Fixed-capacity, allocation-free list of Error
+//!
+//! Holds the first Capacity errors of a command line; the following ones are
+//! only counted (see Dropped()).
+class ErrorBuffer {
+public:
+    enum { Capacity = 16 };
+
+    ErrorBuffer( ) : count( 0 ), dropped( 0 ) {};
+
+    void Clear( ) {
+        this->count = 0;
+        this->dropped = 0;
+    };
+
+    void Push( const Error& error )
+    {
+        if( this->count < static_cast<unsigned int>( Capacity ) )
+            this->buffer[this->count++] = error;
+        else
+            this->dropped++;
+    };
+
+    const Error* begin( ) const {
+        return( this->buffer );
+    };
+
+    const Error* end( ) const {
+        return( this->buffer + this->count );
+    };
+
+    std::size_t size( ) const {
+        return( this->count );
+    };
+
+    bool empty( ) const {
+        return( this->count == 0 );
+    };
+
+    const Error& operator[]( std::size_t k ) const {
+        return( this->buffer[k] );
+    };
+
+    //! Number of errors that did not fit in the buffer
+    unsigned int Dropped( ) const {
+        return( this->dropped );
+    };
+
+private:
+    Error buffer[Capacity]; //!< the first errors, in order of detection
+    unsigned int count; //!< number of errors in buffer
+    unsigned int dropped; //!< number of errors beyond Capacity
+};
+
+namespace detail {
+
+//! \name Byte scanning
+//! FindByte() and CountByte() look for the delimiter of comma-separated
+//! lists. They scan 16 bytes at a time with SSE2 or NEON, 32 with AVX2 when
+//! the processor supports it (checked once, at run time), and fall back on
+//! memchr and std::count otherwise. Define YAAP_NO_SIMD to force the latter.
+//! \{
+
+inline const char* FindByteScalar( const char* first, const char* last, char c )
+{
+    const void* found = std::memchr( first, c, static_cast<std::size_t>( last - first ) );
+    return( found ? static_cast<const char*>( found ) : last );
+}
+
+inline std::size_t CountByteScalar( const char* first, const char* last, char c )
+{
+    return( static_cast<std::size_t>( std::count( first, last, c ) ) );
+}
+
+#ifdef YAAP_HAS_SSE2
+inline const char* FindByteSSE2( const char* first, const char* last, char c )
+{
+    const __m128i needle = _mm_set1_epi8( c );
+    for( ; last - first >= 16; first += 16 )
+    {
+        __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( first ) );
+        int mask = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, needle ) );
+        if( mask != 0 )
+            return( first + __builtin_ctz( mask ) );
+    }
+    return( FindByteScalar( first, last, c ) );
+}
+
+inline std::size_t CountByteSSE2( const char* first, const char* last, char c )
+{
+    const __m128i needle = _mm_set1_epi8( c );
+    std::size_t count = 0;
+    for( ; last - first >= 16; first += 16 )
+    {
+        __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( first ) );
+        count += __builtin_popcount( _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, needle ) ) );
+    }
+    return( count + CountByteScalar( first, last, c ) );
+}
+#endif
+
+#ifdef YAAP_HAS_AVX2_DISPATCH
+__attribute__(( target( "avx2" ) ))
+inline const char* FindByteAVX2( const char* first, const char* last, char c )
+{
+    const __m256i needle = _mm256_set1_epi8( c );
+    for( ; last - first >= 32; first += 32 )
+    {
+        __m256i chunk = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( first ) );
+        unsigned int mask = static_cast<unsigned int>( _mm256_movemask_epi8( _mm256_cmpeq_epi8( chunk, needle ) ) );
+        if( mask != 0 )
+            return( first + __builtin_ctz( mask ) );
+    }
+    return( FindByteSSE2( first, last, c ) );
+}
+
+__attribute__(( target( "avx2" ) ))
+inline std::size_t CountByteAVX2( const char* first, const char* last, char c )
+{
+    const __m256i needle = _mm256_set1_epi8( c );
+    std::size_t count = 0;
+    for( ; last - first >= 32; first += 32 )
+    {
+        __m256i chunk = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( first ) );
+        count += __builtin_popcount( static_cast<unsigned int>( _mm256_movemask_epi8( _mm256_cmpeq_epi8( chunk, needle ) ) ) );
+    }
+    return( count + CountByteSSE2( first, last, c ) );
+}
+
+inline bool HasAVX2( )
+{
+    static const bool avx2 = __builtin_cpu_supports( "avx2" );
+    return( avx2 );
+}
+#endif
+
+#ifdef YAAP_HAS_NEON
+inline const char* FindByteNEON( const char* first, const char* last, char c )
+{
+    const uint8x16_t needle = vdupq_n_u8( static_cast<uint8_t>( c ) );
+    for( ; last - first >= 16; first += 16 )
+    {
+        uint8x16_t eq = vceqq_u8( vld1q_u8( reinterpret_cast<const uint8_t*>( first ) ), needle );
+        // 4 bits per byte
+        uint64_t mask = vget_lane_u64( vreinterpret_u64_u8( vshrn_n_u16( vreinterpretq_u16_u8( eq ), 4 ) ), 0 );
+        if( mask != 0 )
+            return( first + ( __builtin_ctzll( mask ) >> 2 ) );
+    }
+    return( FindByteScalar( first, last, c ) );
+}
+
+inline std::size_t CountByteNEON( const char* first, const char* last, char c )
+{
+    const uint8x16_t needle = vdupq_n_u8( static_cast<uint8_t>( c ) );
+    std::size_t count = 0;
+    for( ; last - first >= 16; first += 16 )
+    {
+        uint8x16_t eq = vceqq_u8( vld1q_u8( reinterpret_cast<const uint8_t*>( first ) ), needle );
+        count += vaddvq_u8( vshrq_n_u8( eq, 7 ) );
+    }
+    return( count + CountByteScalar( first, last, c ) );
+}
+#endif
+
+//! Find the first c in [first, last). \return last if not found
+inline const char* FindByte( const char* first, const char* last, char c )
+{
+#if defined( YAAP_HAS_AVX2_DISPATCH )
+    if( HasAVX2() )
+        return( FindByteAVX2( first, last, c ) );
+    return( FindByteSSE2( first, last, c ) );
+#elif defined( YAAP_HAS_SSE2 )
+    return( FindByteSSE2( first, last, c ) );
+#elif defined( YAAP_HAS_NEON )
+    return( FindByteNEON( first, last, c ) );
+#else
+    return( FindByteScalar( first, last, c ) );
+#endif
+}
+
+//! Count the occurrences of c in [first, last)
+inline std::size_t CountByte( const char* first, const char* last, char c )
+{
+#if defined( YAAP_HAS_AVX2_DISPATCH )
+    if( HasAVX2() )
+        return( CountByteAVX2( first, last, c ) );
+    return( CountByteSSE2( first, last, c ) );
+#elif defined( YAAP_HAS_SSE2 )
+    return( CountByteSSE2( first, last, c ) );
+#elif defined( YAAP_HAS_NEON )
+    return( CountByteNEON( first, last, c ) );
+#else
+    return( CountByteScalar( first, last, c ) );
+#endif
+}
+
+//! \}
+
+//! \name UTF-8 encoding of wide strings
+//! The arguments of a wide command line (see Parser::Parser( int, wchar_t** ))
+//! are encoded in UTF-8 by code point, from UTF-16 for 16-bit units and
+//! from UTF-32 otherwise. An unpaired surrogate or an invalid code point
+//! becomes U+FFFD. Runs of ASCII characters, the common case, are checked
+//! and narrowed 8 (UTF-16) or 4 (UTF-32) units at a time with SSE2.
+//! \{
+
+//! Value of the code unit u, whatever the signedness of Unit
+template<typename Unit>
+inline unsigned long CodeUnit( Unit u ) {
+    return( static_cast<unsigned long>( u ) & ( sizeof( Unit ) == 2 ? 0xFFFFUL : 0xFFFFFFFFUL ) );
+}
+
+//! Copy the leading ASCII units of [first, last) to out as bytes, unless
+//! out is NULL. \return the number of leading ASCII units
+template<typename Unit>
+inline std::size_t NarrowAscii( const Unit* first, const Unit* last, char* out )
+{
+    std::size_t n = 0;
+    std::size_t size = static_cast<std::size_t>( last - first );
+#ifdef YAAP_HAS_SSE2
+    if( sizeof( Unit ) == 2 )
+    {
+        const __m128i high = _mm_set1_epi16( static_cast<short>( 0xFF80 ) );
+        for( ; n + 8 <= size; n += 8 )
+        {
+            __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( first + n ) );
+            if( _mm_movemask_epi8( _mm_cmpeq_epi16( _mm_and_si128( chunk, high ), _mm_setzero_si128() ) ) != 0xFFFF )
+                break;
+            if( out != NULL )
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( out + n ), _mm_packus_epi16( chunk, chunk ) );
+        }
+    }
+    else if( sizeof( Unit ) == 4 )
+    {
+        const __m128i high = _mm_set1_epi32( static_cast<int>( 0xFFFFFF80 ) );
+        for( ; n + 4 <= size; n += 4 )
+        {
+            __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( first + n ) );
+            if( _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( chunk, high ), _mm_setzero_si128() ) ) != 0xFFFF )
+                break;
+            if( out != NULL )
+            {
+                __m128i narrow = _mm_packs_epi32( chunk, chunk );
+                int bytes = _mm_cvtsi128_si32( _mm_packus_epi16( narrow, narrow ) );
+                std::memcpy( out + n, &bytes, 4 );
+            }
+        }
+    }
+#endif
+    for( ; n < size && CodeUnit( first[n] ) < 0x80; n++ )
+        if( out != NULL )
+            out[n] = static_cast<char>( first[n] );
+    return( n );
+}
+
+//! Decode the code point at first, which is moved past it
+template<typename Unit>
+inline unsigned long DecodeWide( const Unit*& first, const Unit* last )
+{
+    unsigned long c = CodeUnit( *first++ );
+    if( sizeof( Unit ) == 2 && c >= 0xD800 && c < 0xDC00 && first != last
+     && CodeUnit( *first ) >= 0xDC00 && CodeUnit( *first ) < 0xE000 )
+        return( 0x10000 + ( ( c - 0xD800 ) << 10 ) + ( CodeUnit( *first++ ) - 0xDC00 ) );
+    if( ( c >= 0xD800 && c < 0xE000 ) || c > 0x10FFFF )
+        return( 0xFFFD );
+    return( c );
+}
+
+//! Number of UTF-8 bytes of the code point c
+inline std::size_t Utf8Size( unsigned long c ) {
+    return( c < 0x80 ? 1 : ( c < 0x800 ? 2 : ( c < 0x10000 ? 3 : 4 ) ) );
+}
+
+//! Number of UTF-8 bytes of [first, last)
+template<typename Unit>
+inline std::size_t Utf8Length( const Unit* first, const Unit* last )
+{
+    std::size_t length = 0;
+    while( first != last )
+    {
+        std::size_t n = NarrowAscii( first, last, static_cast<char*>( NULL ) );
+        first += n;
+        length += n;
+        if( first != last )
+            length += Utf8Size( DecodeWide( first, last ) );
+    }
+    return( length );
+}
+
+//! Encode [first, last) in UTF-8 into out, which has room for
+//! Utf8Length( first, last ) bytes. \return past the last byte written
+template<typename Unit>
+inline char* EncodeUtf8( const Unit* first, const Unit* last, char* out )
+{
+    while( first != last )
+    {
+        std::size_t n = NarrowAscii( first, last, out );
+        first += n;
+        out += n;
+        if( first == last )
+            break;
+        unsigned long c = DecodeWide( first, last );
+        std::size_t size = Utf8Size( c );
+        static const unsigned char lead[5] = { 0, 0, 0xC0, 0xE0, 0xF0 };
+        for( std::size_t k = size - 1; k > 0; k-- )
+        {
+            out[k] = static_cast<char>( 0x80 | ( c & 0x3F ) );
+            c >>= 6;
+        }
+        out[0] = static_cast<char>( lead[size] | c );
+        out += size;
+    }
+    return( out );
+}
+
+//! \}
+
+} // namespace detail
+
+//! \struct Span
+//! \brief Characters [first, last) of a command line argument
+struct Span {
+    const char* first;
+    const char* last;
+};
+
+//! \class SmallVector
+//! \brief Vector storing up to N elements inline
+//!
+//! The first N elements are kept in the object itself; the elements are moved
+//! to a std::vector only when more are added or reserved.
+template<typename T, unsigned int N>
+class SmallVector {
+public:
+    SmallVector( ) : count( 0 ), spilled( false ) {};
+
+    //! Add a value at the end
+    void push_back( const T& value )
+    {
+        if( !this->spilled && this->count == N )
+            this->Spill( N + 1 );
+        if( this->spilled )
+            this->heap.push_back( value );
+        else
+            this->values[this->count] = value;
+        this->count++;
+    };
+
+    //! Ensure room for n elements, with a single allocation if n > N
+    void reserve( std::size_t n )
+    {
+        if( n <= N )
+            return;
+        if( this->spilled )
+            this->heap.reserve( n );
+        else
+            this->Spill( n );
+    };
+
+    T& operator[]( std::size_t pos ) {
+        return( this->spilled ? this->heap[pos] : this->values[pos] );
+    };
+
+    //! Remove the elements, keeping the memory
+    void clear( )
+    {
+        this->heap.clear();
+        this->count = 0;
+    };
+
+    std::size_t size( ) const {
+        return( this->count );
+    };
+
+private:
+    //! Move the inline elements in the heap vector, with room for n elements
+    void Spill( std::size_t n )
+    {
+        this->heap.reserve( n );
+        this->heap.assign( this->values, this->values + this->count );
+        this->spilled = true;
+    };
+
+    T values[N]; //!< inline elements
+    std::vector<T> heap; //!< elements once there are more than N
+    std::size_t count; //!< number of elements
+    bool spilled; //!< if true, the elements are in heap
+};
+
+//! \class OptionArg
+//! \brief Defines an option with possibly several arguments
+//!
+//! This is a templated class derived from Option. It adds a vector of
+//! arguments which type and number is defined by the template statements T
+//! and N.
+template<typename T>
 class OptionArg : public Option {
 
-public:
-    //! constructor
-    OptionArg( char flag, std::string longName, std::string description, unsigned int nbargs = yaap::undef ):Option(flag,longName,description)
+public:
+    //! constructor
+    OptionArg( char flag, std::string longName, std::string description, unsigned int nbargs = yaap::undef ):Option(flag,longName,description)
+    {
+        this->nbArgs = nbargs;
+        this->lazy = false;
+        this->buffer = NULL;
+        this->capacity = 0;
+        this->nbBound = 0;
+        this->overflowed = false;
+        this->hasRange = false;
+        this->checker = NULL;
+        this->minimum = T();
+        this->maximum = T();
+        this->argVector.reserve( nbargs );
+    };
+
+    //! If lazy is true, AddArgument() only records the argument characters,
+    //! which are converted at the first access to the values or by Validate()
+    void SetLazyConversion( bool lazy ) {
+        this->lazy = lazy && this->buffer == NULL;
+    };
+
+    //! Convert the arguments straight into values[0] to values[size - 1]
+    //! instead of an internal vector. Arguments beyond size are refused, see
+    //! Overflowed(). A bound option is always converted at parse time.
+    void Bind( T* values, std::size_t size )
+    {
+        this->buffer = values;
+        this->capacity = size;
+        this->lazy = false;
+    };
+
+    //! If true, an argument was refused because the bound buffer was full
+    bool Overflowed( ) const {
+        return( this->overflowed );
+    };
+
+    //! Accept only values between minimum and maximum, included. Checked
+    //! by Parser::Validate().
+    void SetRange( const T& minimum, const T& maximum )
+    {
+        this->hasRange = true;
+        this->minimum = minimum;
+        this->maximum = maximum;
+        this->checker = &OptionArg<T>::Check;
+    };
+
+    //! Accept only values equal to one of choices. Checked by Parser::Validate().
+    void SetChoices( const std::vector<T>& choices )
+    {
+        this->choices = choices;
+        this->checker = &OptionArg<T>::Check;
+    };
+
+    virtual ValueCheck CheckValues( unsigned int& pos )
+    {
+        pos = 0;
+        if( this->checker == NULL )
+            return( ValuesOk );
+        this->Validate();
+        ValueCheck check = this->checker( *this, pos );
+        if( check != ValuesOk )
+            this->RaiseError();
+        return( check );
+    };
+
+    //! Start a new occurrence of the option: the arguments added next belong
+    //! to it, see GetOccurrenceArgument()
+    void BeginOccurrence( )
+    {
+        this->occurrences.push_back( static_cast<unsigned int>( this->GetNumberOfArguments() ) );
+        this->AddOccurrences( 1 );
+    };
+
+    //! Ensure room for nb more occurrences
+    void ReserveOccurrences( std::size_t nb ) {
+        this->occurrences.reserve( this->occurrences.size() + nb );
+    };
+
+    //! Ensure room for nb more arguments (e.g. the elements of a comma list)
+    void ReserveArguments( std::size_t nb ) {
+        if( this->lazy )
+            this->spans.reserve( this->spans.size() + nb );
+        else if( this->buffer == NULL )
+            this->argVector.reserve( this->argVector.size() + nb );
+    };
+
+    //! Convert the characters [first, last) and add the value at the end of
+    //! the arg list. Raise the error flag if the conversion fails.
+    //! With lazy conversion, the characters are only recorded.
+    //! \return a pointer past the last converted character, see Converter
+    const char* AddArgument( const char* first, const char* last )
+    {
+        if( this->lazy )
+        {
+            Span span = { first, last };
+            this->spans.push_back( span );
+            return( last );
+        }
+        const char* stop = this->Convert( first, last );
+        if( stop != last )
+        {
+            this->RaiseError( stop );
+        }
+        return( stop );
+    };
+
+    //! Convert the recorded arguments, if any
+    //! \return false if the error flag is raised
+    virtual bool Validate( )
+    {
+        if( this->argVector.size() < this->spans.size() )
+        {
+            this->argVector.reserve( this->spans.size() );
+            for( std::size_t k = this->argVector.size(); k < this->spans.size(); k++ )
+            {
+                T arg = T();
+                const char* stop = Converter<T>::Convert( this->spans[k].first, this->spans[k].last, arg );
+                if( stop != this->spans[k].last )
+                {
+                    this->RaiseError( stop );
+                    this->failures.push_back( stop );
+                }
+                this->argVector.push_back( arg );
+            }
+        }
+        return( !this->ErrorFlag() );
+    };
+
+    virtual void TakeFailures( std::vector<const char*>& stops )
+    {
+        for( std::size_t k = 0; k < this->failures.size(); k++ )
+            stops.push_back( this->failures[k] );
+        this->failures.clear();
+    };
+
+    virtual void Reset( )
+    {
+        Option::Reset();
+        this->argVector.clear();
+        this->occurrences.clear();
+        this->spans.clear();
+        this->failures.clear();
+        this->nbBound = 0;
+        this->overflowed = false;
+    };
+
+    //! Get the pos-th arg of type T
+    T GetArgument( unsigned int pos ) {
+        this->Validate();
+        return( this->Value( pos ) );
+    };
+
+    //! Get the pos-th arg of type T
+    std::size_t GetNumberOfArguments(  )
+    {
+      return( this->lazy ? this->spans.size() : this->NumberOfValues() );
+    };
+
+    //! Convenience function for 1-subarg argument
+    T GetValue( ) {
+        this->Validate();
+        return( this->Value( 0 ) );
+    };
+
+    //! Number of occurrences of the option, in command line order. Their
+    //! arguments follow each other in the arguments of the option.
+    std::size_t GetNumberOfOccurrences( ) const {
+        return( this->occurrences.size() );
+    };
+
+    //! Number of arguments of the occ-th occurrence (the elements of its
+    //! comma list, or nbArgs)
+    std::size_t GetOccurrenceSize( unsigned int occ ) {
+        return( this->OccurrenceEnd( occ ) - this->occurrences[occ] );
+    };
+
+    //! Get the pos-th argument of the occ-th occurrence
+    T GetOccurrenceArgument( unsigned int occ, unsigned int pos ) {
+        return( this->GetArgument( this->occurrences[occ] + pos ) );
+    };
+
+    using Option::CLUsage;
+
+    //! Append to out how to use the option in the command line format
+    virtual void CLUsage( std::string& out )
+    {
+        detail::AppendOptionSynopsis( out, this->flag, this->longName.c_str(), true, this->nbArgs );
+    };
+
+    //! Append the converted values to blob, see Option::Serialize()
+    virtual void Serialize( std::string& blob, detail::BlobRecord& record )
+    {
+        this->Validate();
+        record.kind = detail::BlobCodec<T>::Kind();
+        record.count = static_cast<unsigned int>( this->NumberOfValues() );
+        record.elementSize = detail::BlobElementSize<T>();
+        record.values = detail::BlobCodec<T>::Reserve( blob, record.count );
+        for( std::size_t k = 0; k < record.count; k++ )
+            detail::BlobCodec<T>::Write( blob, record.values, k, this->Value( k ) );
+    };
+
+protected:
+    //! Check the values of option against its range and choices. Only
+    //! instantiated by SetRange() and SetChoices(), so that T needs operator<
+    //! and operator== only if they are used.
+    static ValueCheck Check( OptionArg<T>& option, unsigned int& pos )
+    {
+        for( pos = 0; pos < option.NumberOfValues(); pos++ )
+        {
+            const T& value = option.Value( pos );
+            if( option.hasRange && ( value < option.minimum || option.maximum < value ) )
+                return( ValueOutOfRange );
+            if( !option.choices.empty()
+             && std::find( option.choices.begin(), option.choices.end(), value ) == option.choices.end() )
+                return( ValueNotAChoice );
+        }
+        pos = 0;
+        return( ValuesOk );
+    };
+
+    //! Number of converted values
+    std::size_t NumberOfValues( ) const {
+        return( this->buffer ? this->nbBound : this->argVector.size() );
+    };
+
+    //! pos-th converted value
+    T& Value( std::size_t pos ) {
+        return( this->buffer ? this->buffer[pos] : this->argVector[pos] );
+    };
+
+    //! Convert [first, last) into the next value, in the bound buffer if any
+    //! \return a pointer past the last converted character, see Converter
+    const char* Convert( const char* first, const char* last )
+    {
+        if( this->buffer == NULL )
+        {
+            T arg = T();
+            const char* stop = Converter<T>::Convert( first, last, arg );
+            this->argVector.push_back( arg );
+            return( stop );
+        }
+        if( this->nbBound == this->capacity )
+        {
+            this->overflowed = true;
+            return( first );
+        }
+        T& value = this->buffer[this->nbBound++];
+        value = T();
+        return( Converter<T>::Convert( first, last, value ) );
+    };
+
+    //! Index of the argument following the occ-th occurrence
+    std::size_t OccurrenceEnd( unsigned int occ ) {
+        return( occ + 1 < this->occurrences.size() ? this->occurrences[occ + 1] : this->GetNumberOfArguments() );
+    };
+
+    unsigned int nbArgs; //!< Number of arguments of this specific option
+    SmallVector<T, 8> argVector; //!< Vector of arguments of type T; fixed-arity options up to 8 arguments are stored inline
+    SmallVector<unsigned int, 4> occurrences; //!< index of the first argument of each occurrence
+    SmallVector<Span, 8> spans; //!< characters of the arguments not converted yet (lazy conversion)
+    SmallVector<const char*, 2> failures; //!< lazy conversion failures, see TakeFailures()
+    bool lazy; //!< if true, the conversion is postponed to the first access
+    T* buffer; //!< user buffer the values are converted into, NULL if none (see Bind())
+    std::size_t capacity; //!< number of values buffer can hold
+    std::size_t nbBound; //!< number of values converted into buffer
+    bool overflowed; //!< true if an argument did not fit in buffer
+    bool hasRange; //!< if true, values must be in [minimum, maximum]
+    T minimum; //!< smallest accepted value, see SetRange()
+    T maximum; //!< largest accepted value, see SetRange()
+    std::vector<T> choices; //!< accepted values if not empty, see SetChoices()
+    ValueCheck ( *checker )( OptionArg<T>& option, unsigned int& pos ); //!< Check(), NULL if no range nor choices
+};
+
+//! \class OperandBase
+//! \brief define a command line operand
+//! 
+//! This is a bare base class intended to be used as std::vector element. 
+//! \see Operand<T>
+class OperandBase{
+public:
+    OperandBase( const std::string& description){
+        this->description = description;
+    };
+    virtual ~OperandBase(){};
+
+    const std::string& GetDescription( ) const {
+        return( this->description );
+    };
+
+    //! Convert the characters [first, last) into the operand value
+    //! \return a pointer past the last converted character, see Converter
+    virtual const char* SetValue( const char* first, const char* last )
+    {
+        (void)first;
+        return( last );
+    };
+
+    //! Append the value of the operand to blob, see Option::Serialize()
+    virtual void Serialize( std::string& blob, detail::BlobRecord& record )
+    {
+        (void)blob;
+        record.kind = detail::OpaqueBlob;
+        record.values = 0;
+        record.count = 0;
+        record.elementSize = 0;
+    };
+
+private:
+    std::string description; //!< short description of the operand's role
+};    
+
+//! \class Operand
+//! \brief Implement a defined type for a command line operand
+template<typename T>
+class Operand : public OperandBase{
+public:
+    Operand( const std::string& description ):OperandBase( description ){
+    };
+
+    virtual const char* SetValue( const char* first, const char* last )
+    {
+        this->value = T();
+        return( Converter<T>::Convert( first, last, this->value ) );
+    };
+
+    T GetValue( ){
+        return( this->value );
+    };
+
+    virtual void Serialize( std::string& blob, detail::BlobRecord& record )
+    {
+        record.kind = detail::BlobCodec<T>::Kind();
+        record.count = 1;
+        record.elementSize = detail::BlobElementSize<T>();
+        record.values = detail::BlobCodec<T>::Reserve( blob, 1 );
+        detail::BlobCodec<T>::Write( blob, record.values, 0, this->value );
+    };
+
+private:
+    T value;
+};
+
+//! \struct Token
+//! \brief Position of a flag character in the argument vector
+struct Token {
+    unsigned int argId; //!< index of the argument in argv
+    unsigned int charId; //!< index of the flag character in argv[argId]
+};
+
+//! \struct LongToken
+//! \brief A '--name' argument of the argument vector
+struct LongToken {
+    const char* name; //!< points to argv[argId]+2
+    unsigned int argId; //!< index of the argument in argv
+};
+
+//! \class OperandRange
+//! \brief Range over the remaining operands, converted one at a time
+//!
+//! The range does not store nor convert anything by itself: each operand is
+//! converted with yaap::Converter when its iterator is dereferenced.
+template<typename T>
+class OperandRange {
+public:
+    class iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef T reference;
+
+        explicit iterator( char** arg = NULL ) : arg( arg ) {};
+
+        //! Convert the operand. \return false if the conversion failed
+        bool GetValue( T& value ) const
+        {
+            const char* last = *this->arg + std::strlen( *this->arg );
+            value = T();
+            return( Converter<T>::Convert( *this->arg, last, value ) == last );
+        };
+
+        //! Get the converted operand (T() from a failed conversion)
+        T operator*( ) const
+        {
+            T value;
+            this->GetValue( value );
+            return( value );
+        };
+
+        //! Get the raw command line argument
+        const char* Argument( ) const {
+            return( *this->arg );
+        };
+
+        iterator& operator++( )
+        {
+            this->arg++;
+            return( *this );
+        };
+
+        iterator operator++( int )
+        {
+            iterator previous = *this;
+            this->arg++;
+            return( previous );
+        };
+
+        bool operator==( const iterator& other ) const {
+            return( this->arg == other.arg );
+        };
+
+        bool operator!=( const iterator& other ) const {
+            return( this->arg != other.arg );
+        };
+
+    private:
+        char** arg; //!< current argument in argv
+    };
+
+    OperandRange( char** first, char** last ) : first( first ), last( last ) {};
+
+    iterator begin( ) const {
+        return( iterator( this->first ) );
+    };
+
+    iterator end( ) const {
+        return( iterator( this->last ) );
+    };
+
+    std::size_t size( ) const {
+        return( static_cast<std::size_t>( this->last - this->first ) );
+    };
+
+    bool empty( ) const {
+        return( this->first == this->last );
+    };
+
+private:
+    char** first; //!< first operand in argv
+    char** last; //!< past the last operand in argv
+};
+
+//! \class Tokenizer
+//! \brief Single-pass index of the command line
+//!
+//! The argument vector is scanned once. Every flag character of a '-abc'
+//! cluster is recorded in a per-flag bucket (in command line order) and every
+//! '--name' argument is recorded in a table sorted by name. Options are then
+//! resolved by a lookup in these tables instead of a new scan of argv.
+class Tokenizer {
+public:
+    Tokenizer( )
+    {
+        for( unsigned int f = 0; f <= 256; f++ )
+            this->flagOffset[f] = 0;
+    };
+
+    //! Build the tables from the argument vector
+    void Tokenize( unsigned int argc, char** argv )
+    {
+        unsigned int count[256] = { 0 };
+        this->flagTokens.clear();
+        this->longTokens.clear();
+        // first pass: count flags per bucket and collect long names
+        for( unsigned int i = 1; i < argc; i++ )
+        {
+            if( argv[i][0] != '-' )
+                continue;
+            for( unsigned int c = 1; argv[i][c] != '\0' && argv[i][c] != '-'; c++ )
+                count[static_cast<unsigned char>( argv[i][c] )]++;
+            if( argv[i][1] == '-' && argv[i][2] != '\0' )
+            {
+                LongToken token = { argv[i] + 2, i };
+                this->longTokens.push_back( token );
+            }
+        }
+        // bucket offsets
+        this->flagOffset[0] = 0;
+        for( unsigned int f = 0; f < 256; f++ )
+            this->flagOffset[f + 1] = this->flagOffset[f] + count[f];
+        // second pass: fill the buckets, in command line order
+        this->flagTokens.resize( this->flagOffset[256] );
+        unsigned int fill[256];
+        std::copy( this->flagOffset, this->flagOffset + 256, fill );
+        for( unsigned int i = 1; i < argc; i++ )
+        {
+            if( argv[i][0] != '-' )
+                continue;
+            for( unsigned int c = 1; argv[i][c] != '\0' && argv[i][c] != '-'; c++ )
+            {
+                Token token = { i, c };
+                this->flagTokens[fill[static_cast<unsigned char>( argv[i][c] )]++] = token;
+            }
+        }
+        std::stable_sort( this->longTokens.begin(), this->longTokens.end(), LongTokenLess );
+    };
+
+    //! Update the tables for an edition of the argument vector at index:
+    //! removed, if not NULL, was replaced (delta 0) or erased (delta -1),
+    //! added, if not NULL, replaced it or was inserted (delta 1). The cost
+    //! depends on the number of tokens, not on the length of the arguments.
+    void Edit( unsigned int index, const char* removed, const char* added, int delta )
+    {
+        if( removed != NULL && removed[0] == '-' )
+        {
+            for( unsigned int c = 1; removed[c] != '\0' && removed[c] != '-'; c++ )
+            {
+                unsigned int f = static_cast<unsigned char>( removed[c] );
+                unsigned int k = this->flagOffset[f];
+                while( this->flagTokens[k].argId != index || this->flagTokens[k].charId != c )
+                    k++;
+                this->flagTokens.erase( this->flagTokens.begin() + k );
+                for( unsigned int g = f + 1; g <= 256; g++ )
+                    this->flagOffset[g]--;
+            }
+            if( removed[1] == '-' && removed[2] != '\0' )
+            {
+                LongToken key = { removed + 2, index };
+                this->longTokens.erase( std::lower_bound( this->longTokens.begin(), this->longTokens.end(),
+                                                          key, LongTokenLess ) );
+            }
+        }
+        // the following arguments move
+        if( delta != 0 )
+        {
+            unsigned int first = delta > 0 ? index : index + 1;
+            for( std::size_t k = 0; k < this->flagTokens.size(); k++ )
+                if( this->flagTokens[k].argId >= first )
+                    this->flagTokens[k].argId += delta;
+            for( std::size_t k = 0; k < this->longTokens.size(); k++ )
+                if( this->longTokens[k].argId >= first )
+                    this->longTokens[k].argId += delta;
+        }
+        if( added != NULL && added[0] == '-' )
+        {
+            for( unsigned int c = 1; added[c] != '\0' && added[c] != '-'; c++ )
+            {
+                unsigned int f = static_cast<unsigned char>( added[c] );
+                unsigned int k = this->flagOffset[f];
+                while( k < this->flagOffset[f + 1] && this->flagTokens[k].argId <= index )
+                    k++;
+                Token token = { index, c };
+                this->flagTokens.insert( this->flagTokens.begin() + k, token );
+                for( unsigned int g = f + 1; g <= 256; g++ )
+                    this->flagOffset[g]++;
+            }
+            if( added[1] == '-' && added[2] != '\0' )
+            {
+                LongToken token = { added + 2, index };
+                this->longTokens.insert( std::lower_bound( this->longTokens.begin(), this->longTokens.end(),
+                                                           token, LongTokenLess ), token );
+            }
+        }
+    };
+
+    //! Index of the first token of the given flag
+    unsigned int FlagBegin( char flag ) {
+        return( this->flagOffset[static_cast<unsigned char>( flag )] );
+    };
+
+    //! Index past the last token of the given flag
+    unsigned int FlagEnd( char flag ) {
+        return( this->flagOffset[static_cast<unsigned char>( flag ) + 1] );
+    };
+
+    //! Get the k-th flag token, see FlagBegin() and FlagEnd()
+    const Token& FlagToken( unsigned int k ) {
+        return( this->flagTokens[k] );
+    };
+
+    //! Find the range [first, last) of the '--name' tokens
+    void LongRange( const std::string& name, unsigned int& first, unsigned int& last )
+    {
+        LongToken key = { name.c_str(), 0 };
+        std::vector<LongToken>::iterator begin = std::lower_bound( this->longTokens.begin(),
+                                                                   this->longTokens.end(),
+                                                                   key, LongNameLess );
+        std::vector<LongToken>::iterator end = std::upper_bound( begin, this->longTokens.end(),
+                                                                 key, LongNameLess );
+        first = static_cast<unsigned int>( begin - this->longTokens.begin() );
+        last = static_cast<unsigned int>( end - this->longTokens.begin() );
+    };
+
+    //! Get the k-th long token, see LongRange()
+    const LongToken& GetLongToken( unsigned int k ) {
+        return( this->longTokens[k] );
+    };
+
+private:
+    static bool LongNameLess( const LongToken& a, const LongToken& b ) {
+        return( std::strcmp( a.name, b.name ) < 0 );
+    };
+
+    static bool LongTokenLess( const LongToken& a, const LongToken& b ) {
+        int cmp = std::strcmp( a.name, b.name );
+        return( cmp < 0 || ( cmp == 0 && a.argId < b.argId ) );
+    };
+
+    unsigned int flagOffset[257]; //!< flag f owns flagTokens[flagOffset[f], flagOffset[f+1])
+    std::vector<Token> flagTokens; //!< flag tokens, bucketed by flag
+    std::vector<LongToken> longTokens; //!< '--name' tokens sorted by name
+};
+
+//! \class OptionIndex
+//! \brief Constant-time lookup of option identifiers by flag or long name
+//!
+//! Flags are resolved through a 256-entry table, long names through a vector
+//! kept sorted by name and searched by dichotomy.
+class OptionIndex {
+public:
+    static const unsigned int npos = static_cast<unsigned int>( -1 ); //!< not found
+
+    OptionIndex( )
+    {
+        for( unsigned int f = 0; f < 256; f++ )
+            this->flagTable[f] = npos;
+    };
+
+    //! Register the identifier id for the given flag and long name. A '\0'
+    //! flag is not registered: several options may have no flag.
+    //! \return false if the flag or the long name is already registered,
+    //! neither being registered then
+    bool Insert( char flag, const std::string& longName, unsigned int id )
+    {
+        unsigned int& slot = this->flagTable[static_cast<unsigned char>( flag )];
+        if( flag != '\0' && slot != npos )
+            return( false );
+        std::vector<Entry>::iterator it = std::lower_bound( this->longNames.begin(),
+                                                            this->longNames.end(),
+                                                            longName.c_str(), EntryLess );
+        if( !longName.empty() && it != this->longNames.end() && it->first == longName )
+            return( false );
+        if( flag != '\0' )
+            slot = id;
+        if( !longName.empty() )
+            this->longNames.insert( it, Entry( longName, id ) );
+        return( true );
+    };
+
+    //! Get the identifier registered for flag, npos if none
+    unsigned int Find( char flag ) const {
+        return( this->flagTable[static_cast<unsigned char>( flag )] );
+    };
+
+    //! Get the identifier registered for longName, npos if none
+    unsigned int Find( const std::string& longName ) const {
+        return( this->Find( longName.c_str() ) );
+    };
+
+    //! Get the identifier registered for longName, npos if none
+    unsigned int Find( const char* longName ) const
+    {
+        std::vector<Entry>::const_iterator it = std::lower_bound( this->longNames.begin(),
+                                                                  this->longNames.end(),
+                                                                  longName, EntryLess );
+        if( it != this->longNames.end() && it->first.compare( longName ) == 0 )
+            return( it->second );
+        return( npos );
+    };
+
+private:
+    typedef std::pair<std::string, unsigned int> Entry;
+
+    static bool EntryLess( const Entry& entry, const char* name ) {
+        return( entry.first.compare( name ) < 0 );
+    };
+
+    unsigned int flagTable[256]; //!< flag to identifier table
+    std::vector<Entry> longNames; //!< long name to identifier, sorted by name
+};
+
+//! \class Arena
+//! \brief Monotonic memory pool
+//!
+//! Memory is handed out from blocks that are released all together by the
+//! destructor, never one allocation at a time. The first block is part of
+//! the Arena object itself, so that small layouts do not reach malloc.
+class Arena {
+public:
+    enum { InlineSize = 1024, BlockSize = 4096 };
+
+    Arena( )
+    {
+        this->current = this->inlineBlock.bytes;
+        this->remaining = InlineSize;
+        this->blocks = NULL;
+        this->nbAllocations = 0;
+        this->nbBlocks = 0;
+    };
+
+    //! destructor. Release all the blocks at once.
+    ~Arena( )
+    {
+        while( this->blocks != NULL )
+        {
+            Block* next = this->blocks->next;
+            ::operator delete( this->blocks );
+            this->blocks = next;
+        }
+    };
+
+    //! Get size bytes of memory suitably aligned for any type
+    void* Allocate( std::size_t size )
+    {
+        size = ( size + sizeof( MaxAlign ) - 1 ) / sizeof( MaxAlign ) * sizeof( MaxAlign );
+        if( size > this->remaining )
+        {
+            std::size_t payload = size > BlockSize ? size : static_cast<std::size_t>( BlockSize );
+            Block* block = static_cast<Block*>( ::operator new( sizeof( Block ) + payload ) );
+            block->next = this->blocks;
+            this->blocks = block;
+            this->current = reinterpret_cast<char*>( block + 1 );
+            this->remaining = payload;
+            YAAP_STATS( this->nbBlocks++; )
+        }
+        YAAP_STATS( this->nbAllocations++; )
+        void* memory = this->current;
+        this->current += size;
+        this->remaining -= size;
+        return( memory );
+    };
+
+    //! Number of Allocate() calls, counted with YAAP_ENABLE_STATS only
+    unsigned int GetNumberOfAllocations( ) const {
+        return( this->nbAllocations );
+    };
+
+    //! Number of blocks allocated on the heap, counted with YAAP_ENABLE_STATS only
+    unsigned int GetNumberOfBlocks( ) const {
+        return( this->nbBlocks );
+    };
+
+private:
+    Arena( const Arena& ); // not copyable
+    Arena& operator=( const Arena& );
+
+    union MaxAlign { long double ld; double d; long l; void* p; void ( *f )( ); };
+    //! Header of a heap block, padded so that the payload is aligned
+    union Block { Block* next; MaxAlign align; };
+
+    union {
+        MaxAlign align;
+        char bytes[InlineSize];
+    } inlineBlock; //!< first block
+    Block* blocks; //!< heap blocks, most recent first
+    char* current; //!< next free byte of the current block
+    std::size_t remaining; //!< free bytes in the current block
+    unsigned int nbAllocations; //!< see GetNumberOfAllocations()
+    unsigned int nbBlocks; //!< see GetNumberOfBlocks()
+};
+
+//! \class ResponseFile
+//! \brief Arguments read from an '@file' response file
+//!
+//! The file is memory-mapped (privately: it is never written back) or, when
+//! mapping is not possible, read in a single buffer. Arguments are separated
+//! by white spaces; single and double quotes group characters and a
+//! backslash escapes the next character. They are tokenized in place: each
+//! argument is a null-terminated string inside the file buffer, so expanding
+//! a file costs no allocation per argument. The buffer is owned by whoever
+//! calls Release().
+class ResponseFile {
+public:
+    ResponseFile( ) : data( NULL ), size( 0 ), mapped( false ) {};
+
+    //! Load the file. \return false if it cannot be read
+    bool Load( const char* path )
+    {
+#ifdef YAAP_HAS_MMAP
+        int fd = ::open( path, O_RDONLY );
+        if( fd < 0 )
+            return( false );
+        struct stat status;
+        if( ::fstat( fd, &status ) != 0 )
+        {
+            ::close( fd );
+            return( false );
+        }
+        this->size = static_cast<std::size_t>( status.st_size );
+        long page = ::sysconf( _SC_PAGESIZE );
+        // the byte following the file must exist to terminate the last
+        // argument: it does in the zero-filled end of a partial last page
+        if( this->size > 0 && page > 0 && this->size % static_cast<std::size_t>( page ) != 0 )
+        {
+            void* memory = ::mmap( NULL, this->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+            if( memory != MAP_FAILED )
+            {
+                this->data = static_cast<char*>( memory );
+                this->mapped = true;
+                ::close( fd );
+                return( true );
+            }
+        }
+        ::close( fd );
+#endif
+        std::FILE* file = std::fopen( path, "rb" );
+        if( file == NULL )
+            return( false );
+        std::fseek( file, 0, SEEK_END );
+        long length = std::ftell( file );
+        std::fseek( file, 0, SEEK_SET );
+        if( length < 0 )
+        {
+            std::fclose( file );
+            return( false );
+        }
+        this->size = static_cast<std::size_t>( length );
+        this->data = new char[this->size + 1];
+        this->size = std::fread( this->data, 1, this->size, file );
+        this->data[this->size] = '\0';
+        std::fclose( file );
+        return( true );
+    };
+
+    //! File content, null-terminated
+    const char* Data( ) const {
+        return( this->data );
+    };
+
+    std::size_t Size( ) const {
+        return( this->size );
+    };
+
+    //! Release the file buffer; the arguments are no longer valid
+    void Release( )
+    {
+#ifdef YAAP_HAS_MMAP
+        if( this->mapped )
+            ::munmap( this->data, this->size );
+        else
+#endif
+            delete[] this->data;
+        this->data = NULL;
+        this->size = 0;
+        this->mapped = false;
+    };
+
+    //! Split the file into arguments, appended to arguments
+    void Tokenize( std::vector<char*>& arguments )
+    {
+        char* read = this->data;
+        char* end = this->data + this->size;
+        while( read != end )
+        {
+            if( std::isspace( static_cast<unsigned char>( *read ) ) )
+            {
+                read++;
+                continue;
+            }
+            char* token = read;
+            char* write = read; // unquoting only shrinks the argument
+            char quote = '\0';
+            while( read != end )
+            {
+                char c = *read++;
+                if( quote != '\0' && c == quote )
+                    quote = '\0';
+                else if( quote == '\0' && ( c == '\'' || c == '"' ) )
+                    quote = c;
+                else if( quote == '\0' && std::isspace( static_cast<unsigned char>( c ) ) )
+                    break;
+                else
+                {
+                    if( c == '\\' && quote != '\'' && read != end )
+                        c = *read++;
+                    *write++ = c;
+                }
+            }
+            *write = '\0';
+            arguments.push_back( token );
+        }
+    };
+
+private:
+    char* data; //!< file content
+    std::size_t size; //!< file size
+    bool mapped; //!< if true, data is a memory mapping
+};
+
+//! \class Settings
+//! \brief Sorted key/value table of the values of the options missing from argv
+//!
+//! Keys and values are null-terminated strings stored one after the other in
+//! a single buffer ("key\0value\0key\0value\0..."), indexed by the offsets of
+//! the keys sorted in alphabetical order. Lookups are binary searches, as in
+//! OptionIndex. The buffer and the index are saved and loaded as they are,
+//! which makes a snapshot of a configuration file cost a single read.
+class Settings {
+public:
+    Settings( ) : sorted( true ) {};
+
+    void Clear( )
+    {
+        this->data.clear();
+        this->keys.clear();
+        this->sorted = true;
+    };
+
+    bool Empty( ) const {
+        return( this->keys.empty() );
+    };
+
+    //! Add the key/value pair. When a key is added several times, the last
+    //! value wins. Sort() must be called before Find().
+    void Add( const char* key, std::size_t keyLength, const char* value, std::size_t valueLength )
+    {
+        this->keys.push_back( static_cast<unsigned int>( this->data.size() ) );
+        this->data.append( key, keyLength );
+        this->data += '\0';
+        this->data.append( value, valueLength );
+        this->data += '\0';
+        this->sorted = false;
+    };
+
+    //! Sort the keys and remove the overridden values
+    void Sort( )
+    {
+        if( this->sorted )
+            return;
+        std::stable_sort( this->keys.begin(), this->keys.end(), KeyLess( this->data.c_str() ) );
+        // keep the last added of equal keys, that is the last one once sorted
+        std::size_t n = 0;
+        for( std::size_t k = 0; k < this->keys.size(); k++ )
+        {
+            if( k + 1 < this->keys.size()
+             && std::strcmp( this->data.c_str() + this->keys[k], this->data.c_str() + this->keys[k + 1] ) == 0 )
+                continue;
+            this->keys[n++] = this->keys[k];
+        }
+        this->keys.resize( n );
+        this->sorted = true;
+    };
+
+    //! \return the value of key, NULL if none
+    const char* Find( const char* key ) const
+    {
+        std::vector<unsigned int>::const_iterator it =
+            std::lower_bound( this->keys.begin(), this->keys.end(), key, KeyLess( this->data.c_str() ) );
+        if( it == this->keys.end() || std::strcmp( this->data.c_str() + *it, key ) != 0 )
+            return( NULL );
+        const char* found = this->data.c_str() + *it;
+        return( found + std::strlen( found ) + 1 );
+    };
+
+    enum { StampSize = 6 }; //!< number of values identifying a version of the source
+
+    //! Save the table in a snapshot file, tagged with stamp
+    //! \return false if the file cannot be written
+    bool Save( const char* path, const unsigned long long stamp[StampSize] ) const
+    {
+        std::FILE* file = std::fopen( path, "wb" );
+        if( file == NULL )
+            return( false );
+        Header header;
+        std::memcpy( header.magic, Magic(), sizeof( header.magic ) );
+        for( unsigned int k = 0; k < StampSize; k++ )
+            header.stamp[k] = stamp[k];
+        header.dataSize = static_cast<unsigned int>( this->data.size() );
+        header.nbKeys = static_cast<unsigned int>( this->keys.size() );
+        bool success = std::fwrite( &header, sizeof( header ), 1, file ) == 1
+                    && std::fwrite( this->data.data(), 1, this->data.size(), file ) == this->data.size()
+                    && ( this->keys.empty()
+                      || std::fwrite( &this->keys[0], sizeof( unsigned int ), this->keys.size(), file ) == this->keys.size() );
+        return( std::fclose( file ) == 0 && success );
+    };
+
+    //! Load the table from a snapshot file, if it was saved with stamp
+    //! \return false if the file cannot be read or is out of date
+    bool Load( const char* path, const unsigned long long stamp[StampSize] )
+    {
+        std::FILE* file = std::fopen( path, "rb" );
+        if( file == NULL )
+            return( false );
+        Header header;
+        bool success = std::fread( &header, sizeof( header ), 1, file ) == 1
+                    && std::memcmp( header.magic, Magic(), sizeof( header.magic ) ) == 0;
+        for( unsigned int k = 0; success && k < StampSize; k++ )
+            success = header.stamp[k] == stamp[k];
+        if( success )
+        {
+            this->data.resize( header.dataSize );
+            this->keys.resize( header.nbKeys );
+            success = ( header.dataSize == 0 || std::fread( &this->data[0], 1, header.dataSize, file ) == header.dataSize )
+                   && ( header.nbKeys == 0
+                     || std::fread( &this->keys[0], sizeof( unsigned int ), header.nbKeys, file ) == header.nbKeys );
+            for( std::size_t k = 0; success && k < this->keys.size(); k++ )
+                success = this->keys[k] < this->data.size();
+            success = success && ( this->data.empty() || this->data[this->data.size() - 1] == '\0' );
+        }
+        std::fclose( file );
+        if( !success )
+            this->Clear();
+        this->sorted = true;
+        return( success );
+    };
+
+    //! Add the "key = value" lines of an INI-style text. Lines starting with
+    //! '#' or ';' are comments; the keys following a "[section]" line are
+    //! named "section.key". Values may be quoted.
+    void ParseConfiguration( const char* first, const char* last )
+    {
+        std::string section;
+        std::string key;
+        while( first != last )
+        {
+            const char* end = static_cast<const char*>( std::memchr( first, '\n', last - first ) );
+            if( end == NULL )
+                end = last;
+            const char* line = first;
+            const char* lineEnd = end;
+            first = ( end == last ) ? last : end + 1;
+            Trim( line, lineEnd );
+            if( line == lineEnd || *line == '#' || *line == ';' )
+                continue;
+            if( *line == '[' )
+            {
+                if( lineEnd[-1] == ']' )
+                    section.assign( line + 1, lineEnd - 1 );
+                continue;
+            }
+            const char* separator = line;
+            while( separator != lineEnd && *separator != '=' && *separator != ':' )
+                separator++;
+            if( separator == lineEnd )
+                continue;
+            const char* keyEnd = separator;
+            const char* value = separator + 1;
+            Trim( line, keyEnd );
+            Trim( value, lineEnd );
+            if( lineEnd - value >= 2 && ( *value == '"' || *value == '\'' ) && lineEnd[-1] == *value )
+            {
+                value++;
+                lineEnd--;
+            }
+            key = section;
+            if( !key.empty() )
+                key += '.';
+            key.append( line, keyEnd );
+            this->Add( key.data(), key.size(), value, lineEnd - value );
+        }
+    };
+
+private:
+    struct Header {
+        char magic[8]; //!< Magic()
+        unsigned long long stamp[StampSize]; //!< see Parser::LoadConfiguration()
+        unsigned int dataSize; //!< size of data
+        unsigned int nbKeys; //!< size of keys
+    };
+
+    static const char* Magic( ) {
+        return( "yaapcfg2" );
+    };
+
+    //! Remove the white spaces around [first, last)
+    static void Trim( const char*& first, const char*& last )
+    {
+        while( first != last && std::isspace( static_cast<unsigned char>( *first ) ) )
+            first++;
+        while( last != first && std::isspace( static_cast<unsigned char>( last[-1] ) ) )
+            last--;
+    };
+
+    //! Compare keys given by their offset in data
+    struct KeyLess {
+        KeyLess( const char* data ) : data( data ) {};
+        bool operator()( unsigned int a, unsigned int b ) const {
+            return( std::strcmp( this->data + a, this->data + b ) < 0 );
+        };
+        bool operator()( unsigned int a, const char* key ) const {
+            return( std::strcmp( this->data + a, key ) < 0 );
+        };
+        const char* data;
+    };
+
+    std::string data; //!< keys and values, null-terminated
+    std::vector<unsigned int> keys; //!< offsets of the keys in data, in alphabetical order
+    bool sorted; //!< false if keys were added since the last Sort()
+};
+
+//! \class CompletionTrie
+//! \brief Prefix tree of the words a shell can complete
+//!
+//! Nodes are stored in a single vector, each one linking to its first child
+//! and to its next sibling; siblings are kept sorted so that completions come
+//! out in lexicographic order.
+class CompletionTrie {
+public:
+    static const unsigned int npos = static_cast<unsigned int>( -1 ); //!< no node, no word
+
+    CompletionTrie( )
+    {
+        Node root = { '\0', npos, npos, npos };
+        this->nodes.push_back( root );
+    };
+
+    //! Add word, identified by id
+    void Insert( const std::string& word, unsigned int id )
+    {
+        unsigned int node = 0;
+        for( std::size_t k = 0; k < word.size(); k++ )
+        {
+            unsigned char c = static_cast<unsigned char>( word[k] );
+            unsigned int previous = npos;
+            unsigned int child = this->nodes[node].firstChild;
+            while( child != npos && this->nodes[child].c < c )
+            {
+                previous = child;
+                child = this->nodes[child].nextSibling;
+            }
+            if( child == npos || this->nodes[child].c != c )
+            {
+                Node added = { c, npos, child, npos };
+                unsigned int index = static_cast<unsigned int>( this->nodes.size() );
+                this->nodes.push_back( added );
+                if( previous == npos )
+                    this->nodes[node].firstChild = index;
+                else
+                    this->nodes[previous].nextSibling = index;
+                child = index;
+            }
+            node = child;
+        }
+        this->nodes[node].word = id;
+    };
+
+    //! Append to ids the identifiers of the words starting with prefix
+    void Complete( const char* prefix, std::vector<unsigned int>& ids ) const
+    {
+        unsigned int node = 0;
+        for( ; *prefix != '\0'; prefix++ )
+        {
+            unsigned char c = static_cast<unsigned char>( *prefix );
+            node = this->nodes[node].firstChild;
+            while( node != npos && this->nodes[node].c != c )
+                node = this->nodes[node].nextSibling;
+            if( node == npos )
+                return;
+        }
+        this->Collect( node, ids );
+    };
+
+private:
+    struct Node {
+        unsigned char c; //!< character leading to this node
+        unsigned int firstChild; //!< first child node, npos if none
+        unsigned int nextSibling; //!< next sibling node, npos if none
+        unsigned int word; //!< identifier of the word ending here, npos if none
+    };
+
+    void Collect( unsigned int node, std::vector<unsigned int>& ids ) const
+    {
+        if( this->nodes[node].word != npos )
+            ids.push_back( this->nodes[node].word );
+        for( unsigned int child = this->nodes[node].firstChild; child != npos;
+             child = this->nodes[child].nextSibling )
+            this->Collect( child, ids );
+    };
+
+    std::vector<Node> nodes; //!< node 0 is the root (empty prefix)
+};
+
+namespace detail {
+
+//! Append to out the shell script that plugs the --yaap-complete protocol of
+//! the utility argv0 into the given shell (bash, zsh or fish)
+inline bool AppendCompletionScript( const std::string& shell, const char* argv0, std::string& out )
+{
+    std::string program( argv0 );
+    std::string::size_type slash = program.find_last_of( '/' );
+    if( slash != std::string::npos )
+        program = program.substr( slash + 1 );
+    std::string function = "_yaap_" + program;
+    for( std::size_t k = 6; k < function.size(); k++ )
+        if( !std::isalnum( static_cast<unsigned char>( function[k] ) ) )
+            function[k] = '_';
+    if( shell == "fish" )
+    {
+        out += "complete -c " + program + " -f -a '(" + program
+             + " --yaap-complete (commandline -opc)[2..-1] (commandline -ct))'\n";
+        return( true );
+    }
+    if( shell == "zsh" )
+        out += "autoload -U +X bashcompinit && bashcompinit\n";
+    else if( shell != "bash" )
+        return( false );
+    out += function + "() {\n"
+         + "    COMPREPLY=( $( \"${COMP_WORDS[0]}\" --yaap-complete \"${COMP_WORDS[@]:1:$COMP_CWORD}\" ) )\n"
+         + "}\n"
+         + "complete -F " + function + " " + program + "\n";
+    return( true );
+}
+
+//! Environment variables as "name=value" strings, NULL if unknown
+inline char** Environment( )
+{
+#if defined( _WIN32 )
+    return( _environ );
+#elif defined( YAAP_HAS_MMAP )
+    return( environ );
+#else
+    return( NULL );
+#endif
+}
+
+//! true for "1", "true", "yes" and "on", in any case
+inline bool IsTrue( const char* value )
+{
+    const char* words[] = { "1", "true", "yes", "on" };
+    for( unsigned int w = 0; w < 4; w++ )
+    {
+        const char* a = value;
+        const char* b = words[w];
+        while( *a != '\0' && std::tolower( static_cast<unsigned char>( *a ) ) == *b )
+        {
+            a++;
+            b++;
+        }
+        if( *a == '\0' && *b == '\0' )
+            return( true );
+    }
+    return( false );
+}
+
+//! Write out on the standard output with a single call
+inline void WriteOut( const std::string& out )
+{
+    std::fwrite( out.data(), 1, out.size(), stdout );
+    std::fflush( stdout );
+}
+
+#ifdef YAAP_ENABLE_STATS
+//! Monotonic clock, in nanoseconds
+inline unsigned long long StatsClock( )
+{
+#if __cplusplus >= 201103L
+    return( static_cast<unsigned long long>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch() ).count() ) );
+#else
+    return( static_cast<unsigned long long>( std::clock() ) * 1000000000ULL / CLOCKS_PER_SEC );
+#endif
+}
+
+//! Add to counter the time elapsed during its lifetime
+class StatsTimer {
+public:
+    StatsTimer( unsigned long long& counter ) : counter( counter ), start( StatsClock() ) {};
+    ~StatsTimer( ) {
+        this->counter += StatsClock() - this->start;
+    };
+private:
+    unsigned long long& counter; //!< where the time is added
+    unsigned long long start; //!< time of construction
+};
+#endif
+
+} // namespace detail
+
+//! \struct ParserStats
+//! \brief Counters of the work done by a Parser
+//!
+//! Filled only when yaap.h is compiled with YAAP_ENABLE_STATS defined; they
+//! stay 0 otherwise, at no cost. Times are in nanoseconds.
+struct ParserStats {
+    unsigned long long constructorNs; //!< constructor: "--" scan and tokenizer tables
+    unsigned long long addOptionNs; //!< AddOption() and AddOptionArg(), conversions included
+    unsigned long long conversionNs; //!< conversion of the option-arguments and operands
+    unsigned long long usageNs; //!< usage rendering
+    unsigned int nbAddOptions; //!< calls to AddOption() and AddOptionArg()
+    unsigned int argvScans; //!< passes over the whole argument vector
+    unsigned int allocations; //!< objects allocated in the arena
+    unsigned int heapBlocks; //!< arena blocks allocated on the heap
+    unsigned long long bytesConverted; //!< characters given to the converters
+    unsigned long long bytesCopied; //!< characters copied out: usage text and blobs
+};
+
+//! \class Parser
+//! \brief Manages a set of options
+class Parser {
+public:
+    //! constructor. Initializes number of args and argument vector.
+    Parser( int argc, char** argv, std::string description = "" )
+    {
+        this->Initialize( argc, argv, description );
+    };
+
+    //! Parse a wide command line, as given to wmain() on Windows. The
+    //! arguments are encoded in UTF-8 all together, into a single buffer of
+    //! the parser (see detail::EncodeUtf8()), then parsed as a char**
+    //! command line: long names, values and operands are UTF-8 strings.
+    Parser( int argc, wchar_t** argv, std::string description = "" )
+    {
+        YAAP_STATS( unsigned long long start = detail::StatsClock(); )
+        char** encoded = this->EncodeArguments( argc, argv );
+        YAAP_STATS( unsigned long long encoding = detail::StatsClock() - start; )
+        this->Initialize( argc, encoded, description );
+        YAAP_STATS( this->stats.constructorNs += encoding; )
+    };
+
+#ifdef __cpp_char8_t
+    //! Parse a UTF-8 command line, as is
+    Parser( int argc, char8_t** argv, std::string description = "" )
+    {
+        this->Initialize( argc, reinterpret_cast<char**>( argv ), description );
+    };
+#endif
+
+    //! destructor
+    virtual ~Parser()
+    {
+        // options and operands live in the arena: only run their destructors,
+        // the memory is released at once with the arena
+        std::vector<Option*>::iterator optionIterator = this->optionVector.begin(); 
+        while( optionIterator != this->optionVector.end() )
+        {
+            (*optionIterator)->~Option();
+            optionIterator++;
+        }
+        std::vector<OperandBase*>::iterator operandIterator = this->operandVector.begin();
+        while( operandIterator != this->operandVector.end() )
+        {
+            (*operandIterator)->~OperandBase();
+            operandIterator++;
+        }
+#ifdef YAAP_HAS_THREADS
+        // wait for the reads in progress; the deferred ones are dropped
+        for( std::size_t k = 0; k < this->pendingFiles.size(); k++ )
+        {
+            PendingFile* pending = this->pendingFiles[k];
+            if( !pending->taken && pending->ready.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::deferred
+                && pending->ready.get() )
+                pending->file.Release();
+            delete pending;
+        }
+        if( this->pendingConfiguration.valid()
+            && this->pendingConfiguration.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::deferred )
+            this->pendingConfiguration.wait();
+#endif
+        for( unsigned int i = 0; i < this->responseFiles.size(); i++ )
+            this->responseFiles[i].Release();
+        for( std::size_t k = 0; k < this->editedArguments.size(); k++ )
+            delete[] this->editedArguments[k];
+        if( this->dumpStats )
+            this->PrintStats( );
+    };
+
+    //! Replace every '@file' argument by the arguments read from file (see
+    //! ResponseFile), recursively. Must be called before adding the options.
+    //! An argument naming a file that cannot be read is kept as is, and an
+    //! Error::UnreadableFile gives its index in the command line before expansion.
+    //! \return false if a response file cannot be read
+    bool ExpandResponseFiles( )
+    {
+        std::vector<char*> expanded;
+        expanded.reserve( this->nbArgs );
+        std::size_t nbFiles = this->responseFiles.size();
+        bool success = true;
+        YAAP_STATS( this->stats.argvScans++; )
+        for( unsigned int i = 0; i < this->nbArgs; i++ ) // argv[0] is the utility
+            if( !this->Expand( this->argv[i], i == 0 ? MaxDepth : 0, expanded ) )
+            {
+                success = false;
+                this->RecordError( Error::UnreadableFile, i, NULL, NULL, 0 );
+            }
+        if( this->responseFiles.size() != nbFiles )
+        {
+            this->arguments.swap( expanded );
+            this->arguments.push_back( NULL ); // as argv[argc]
+            this->argv = &this->arguments[0];
+            this->nbArgs = static_cast<unsigned int>( this->arguments.size() - 1 );
+            this->Tokenize( );
+        }
+        return( success );
+    };
+
+    //! Let the options missing from the command line take the value of the
+    //! environment variable prefix + long name, in upper case with '-'
+    //! replaced by '_' (YAAP_INPUTFILE for --inputFile). The environment is
+    //! read once, here: call it before adding the options.
+    void UseEnvironment( const char* prefix = "YAAP_" )
+    {
+        this->environment.Clear();
+        char** variable = detail::Environment();
+        std::size_t length = std::strlen( prefix );
+        for( ; variable != NULL && *variable != NULL; variable++ )
+        {
+            const char* equal = std::strchr( *variable, '=' );
+            if( equal != NULL && std::strncmp( *variable, prefix, length ) == 0 )
+                this->environment.Add( *variable + length, equal - *variable - length,
+                                       equal + 1, std::strlen( equal + 1 ) );
+        }
+        this->environment.Sort();
+    };
+
+    //! Let the options missing from the command line and from the
+    //! environment take the value of the "longName = value" lines of an
+    //! INI-style configuration file (see Settings); in a "[name]" section,
+    //! the lines apply to the subcommand name. If snapshotPath is given, the
+    //! parsed file is cached there in binary form, and loaded as is as long
+    //! as the modification and status change times (to the nanosecond where
+    //! available), the size and the inode of path do not change, and path
+    //! was last modified before the snapshot was written.
+    //! Call it before adding the options.
+    //! \return false if the file cannot be read
+    bool SetConfigFile( const std::string& path, const std::string& snapshotPath = "" )
+    {
+#ifdef YAAP_HAS_THREADS
+        if( this->pendingConfiguration.valid() && path == this->pendingPath
+            && snapshotPath == this->pendingSnapshotPath )
+        {
+            bool success = this->pendingConfiguration.get();
+            std::swap( this->configuration, this->prefetchedConfiguration );
+            return( success );
+        }
+#endif
+        return( LoadConfiguration( path, snapshotPath, this->configuration ) );
+    };
+
+#ifdef YAAP_HAS_THREADS
+    //! Start reading, each in a background thread, the '@file' response
+    //! files of the command line and, if path is not empty, the configuration
+    //! file (see SetConfigFile()), so that the reads overlap with one another
+    //! and with the rest of the start-up of the application. The paths are
+    //! resolved now. ExpandResponseFiles() and SetConfigFile( path,
+    //! snapshotPath ) then wait for these files instead of reading them; the
+    //! files named inside a response file are read by ExpandResponseFiles().
+    //! Calling it again reads the response files not read yet, and waits
+    //! for the configuration file of the previous call before the next one.
+    void Prefetch( const std::string& path = "", const std::string& snapshotPath = "" )
+    {
+        for( unsigned int i = 1; i < this->nbArgs; i++ ) // argv[0] is the utility
+        {
+            const char* arg = this->argv[i];
+            if( arg[0] != '@' || arg[1] == '\0' || this->IsPending( arg + 1 ) )
+                continue;
+            PendingFile* pending = new PendingFile;
+            pending->path = arg + 1;
+            pending->taken = false;
+            this->pendingFiles.push_back( pending );
+            pending->ready = Start( [pending]( ) -> bool {
+                if( !pending->file.Load( pending->path.c_str() ) )
+                    return( false );
+                pending->file.Tokenize( pending->fileArguments );
+                return( true );
+            } );
+        }
+        if( !path.empty() )
+        {
+            // both reads would fill prefetchedConfiguration
+            if( this->pendingConfiguration.valid() )
+                this->pendingConfiguration.wait();
+            this->pendingPath = path;
+            this->pendingSnapshotPath = snapshotPath;
+            Settings* settings = &this->prefetchedConfiguration;
+            this->pendingConfiguration = Start( [path, snapshotPath, settings]( ) -> bool {
+                return( LoadConfiguration( path, snapshotPath, *settings ) );
+            } );
+        }
+    };
+
+    //! \return true if the reads started by Prefetch() are over, that is if
+    //! ExpandResponseFiles() and SetConfigFile() would not wait for them
+    bool IsPrefetched( ) const
+    {
+        for( std::size_t k = 0; k < this->pendingFiles.size(); k++ )
+            if( !this->pendingFiles[k]->taken && !IsReady( this->pendingFiles[k]->ready ) )
+                return( false );
+        return( !this->pendingConfiguration.valid() || IsReady( this->pendingConfiguration ) );
+    };
+#endif
+
+    //! Add a simple option with given flag and description to the options
+    //! vector and check its existence.
+    //! \return the instanciated Option
+    Option* AddOption( char flag, std::string longName, std::string description, bool required = false )
+    {
+        YAAP_STATS( detail::StatsTimer timer( this->stats.addOptionNs ); )
+        YAAP_STATS( this->stats.nbAddOptions++; )
+        Option* option = new( this->arena.Allocate( sizeof( Option ) ) ) Option( flag, longName, description );
+        option->SetRequired( required );
+        unsigned int id = static_cast<unsigned int>( this->optionVector.size() );
+        this->AddResolution( &Parser::ResolveOption, false, 0 );
+        this->ResolveOption( option, id );
+        // Put the Option in the options' array.
+        this->PushOption( option );
+        // if required but not found, raise an error
+        this->CheckRequired( option, id );
+        // Return the created Option for the user to use it in the main program
+        return( option );
+    };
+
+    //! Add an option with arguments with given flag and description to the
+    //! options vector, check its existence and perform the sub-arguments
+    //! assignment. There are nsubargs of type T.
+    //! \return the instanciated OptionArg
+    template<class T>
+    OptionArg<T>* AddOptionArg( char flag, std::string longName, std::string description, unsigned int nbsubargs, bool required = false )
+    {
+        return( this->ParseOptionArg<T>( flag, longName, description, nbsubargs, required, NULL, 0 ) );
+    };
+
+    //! Add an option with nbValues arguments of type T, converted straight
+    //! into values[0] to values[nbValues - 1] (see OptionArg::Bind()). The
+    //! array is left untouched if the option is absent; arguments of a
+    //! repeated option that do not fit raise an Error::TooManyValues.
+    //! \return the instanciated OptionArg
+    template<class T>
+    OptionArg<T>* AddOptionArg( char flag, std::string longName, std::string description, T* values, unsigned int nbValues, bool required = false )
+    {
+        return( this->ParseOptionArg<T>( flag, longName, description, nbValues, required, values, nbValues ) );
+    };
+
+#if __cplusplus >= 201103L
+    //! Add an option with N arguments converted straight into values
+    template<class T, std::size_t N>
+    OptionArg<T>* AddOptionArg( char flag, std::string longName, std::string description, std::array<T, N>& values, bool required = false )
+    {
+        return( this->ParseOptionArg<T>( flag, longName, description, static_cast<unsigned int>( N ), required, values.data(), N ) );
+    };
+#endif
+
+#ifdef YAAP_HAS_CXX20
+    //! Add an option with values.size() arguments converted straight into values
+    template<class T, std::size_t E>
+    OptionArg<T>* AddOptionArg( char flag, std::string longName, std::string description, std::span<T, E> values, bool required = false )
+    {
+        return( this->ParseOptionArg<T>( flag, longName, description, static_cast<unsigned int>( values.size() ),
+                                         required, values.data(), values.size() ) );
+    };
+#endif
+
+    template<typename T>
+    Operand<T>* AddOperand( std::string description ){
+
+        Operand<T>* op = new( this->arena.Allocate( sizeof( Operand<T> ) ) ) Operand<T>( description );
+
+        this->ResolveOperand( op, this->operandVector.size() );
+        this->operandVector.push_back( op );
+        return( op );
+    };
+
+    //! Get the option registered with the given flag, NULL if none
+    Option* GetOption( char flag )
+    {
+        unsigned int id = this->optionIndex.Find( flag );
+        return( id == OptionIndex::npos ? NULL : this->optionVector[id] );
+    };
+
+    //! Get the option registered with the given long name, NULL if none
+    Option* GetOption( const std::string& longName )
+    {
+        unsigned int id = this->optionIndex.Find( longName );
+        return( id == OptionIndex::npos ? NULL : this->optionVector[id] );
+    };
+
+    //! Declare the subcommand name. If it is the first argument of the command
+    //! line (as in "tool name -v ..."), builder( *this ) is called right away
+    //! to add the options of the subcommand, and the first operand comes after
+    //! it. Otherwise builder is never called, so only the options of the
+    //! selected subcommand are ever registered.
+    //! \return true if the subcommand is selected
+    template<typename Builder>
+    bool AddSubcommand( const std::string& name, Builder builder, std::string description = "" )
+    {
+        this->subcommandVector.push_back( std::make_pair( name, description ) );
+        this->usageValid = false;
+        if( !this->subcommand.empty() || this->nbArgs < 2 || name.compare( this->argv[1] ) != 0 )
+            return( false );
+        this->subcommand = name;
+        if( this->operandOffset == 1 )
+            this->operandOffset = 2;
+        builder( *this );
+        return( true );
+    };
+
+    //! Answer a shell completion request, once the options are added.
+    //! "utility --yaap-complete word1 ... wordN" prints the options (and
+    //! subcommands) starting with wordN, the other words being parsed as the
+    //! command line typed so far; "utility --yaap-complete-script bash" (or
+    //! zsh, fish) prints the script that plugs this into the shell.
+    //! \return true if the command line was a completion request, that the
+    //! utility should then leave right away
+    bool Complete( )
+    {
+        if( !this->completing )
+            return( false );
+        std::string out;
+        if( !this->completionShell.empty() )
+        {
+            if( !detail::AppendCompletionScript( this->completionShell, this->argv[0], out ) )
+                out = "unknown shell '" + this->completionShell + "' (bash, zsh or fish)\n";
+            detail::WriteOut( out );
+            return( true );
+        }
+        std::vector<std::string> words;
+        for( unsigned int i = 0; i < this->optionVector.size(); i++ )
+        {
+            if( this->optionVector[i]->Flag() != '\0' )
+                words.push_back( std::string( "-" ) + this->optionVector[i]->Flag() );
+            if( !this->optionVector[i]->LongName().empty() )
+                words.push_back( "--" + this->optionVector[i]->LongName() );
+        }
+        if( this->subcommand.empty() && this->nbArgs <= 1 )
+            for( unsigned int i = 0; i < this->subcommandVector.size(); i++ )
+                words.push_back( this->subcommandVector[i].first );
+        CompletionTrie trie;
+        for( unsigned int id = 0; id < words.size(); id++ )
+            trie.Insert( words[id], id );
+        std::vector<unsigned int> ids;
+        trie.Complete( this->completionWord, ids );
+        for( unsigned int k = 0; k < ids.size(); k++ )
+            out += words[ids[k]] + "\n";
+        detail::WriteOut( out );
+        return( true );
+    };
+
+    //! Get the selected subcommand, empty if none
+    const std::string& GetSubcommand( ) {
+        return( this->subcommand );
+    };
+
+    //! Get the operands not yet taken by AddOperand(), up to the end of the
+    //! command line. They are converted one by one while iterating.
+    template<typename T>
+    OperandRange<T> Operands( )
+    {
+        unsigned int first = this->operandOffset < this->nbArgs ? this->operandOffset : this->nbArgs;
+        return( OperandRange<T>( this->argv + first, this->argv + this->nbArgs ) );
+    };
+
+    OperandBase* GetOperand( unsigned int pos ){
+        return( this->operandVector[pos] );
+    };
+
+    //! Write in blob a flat copy of the parsed command line: for each option
+    //! its existence, error flag and converted values, the values of the
+    //! operands added, and the remaining operands as strings. Positions in the
+    //! blob are offsets, so that another process (a child reading it from a
+    //! pipe or a shared memory) can use it in place through a ResultView,
+    //! without parsing nor converting again. Values of types other than
+    //! arithmetic ones and std::string are not stored.
+    void Serialize( std::string& blob )
+    {
+        this->Validate(); // convert the pending arguments first
+        unsigned int nbOptions = static_cast<unsigned int>( this->optionVector.size() );
+        unsigned int nbOperands = static_cast<unsigned int>( this->operandVector.size() );
+        unsigned int first = this->operandOffset < this->nbArgs ? this->operandOffset : this->nbArgs;
+        detail::BlobHeader header;
+        std::memcpy( header.magic, detail::BlobMagic(), sizeof( header.magic ) );
+        header.nbOptions = nbOptions;
+        header.nbOperands = nbOperands;
+        header.nbArguments = this->nbArgs - first;
+
+        blob.clear();
+        blob.append( sizeof( detail::BlobHeader ) + ( nbOptions + nbOperands ) * sizeof( detail::BlobRecord ), '\0' );
+        for( unsigned int k = 0; k < nbOptions + nbOperands; k++ )
+        {
+            detail::BlobRecord record;
+            if( k < nbOptions )
+            {
+                Option* option = this->optionVector[k];
+                record.flag = option->Flag();
+                record.exists = option->Exists() ? 1 : 0;
+                option->Serialize( blob, record );
+                record.error = option->ErrorFlag() ? 1 : 0;
+                record.name = detail::AppendBlobString( blob, option->LongName().c_str() );
+            }
+            else
+            {
+                OperandBase* operand = this->operandVector[k - nbOptions];
+                record.flag = '\0';
+                record.exists = 1;
+                record.error = 0;
+                operand->Serialize( blob, record );
+                record.name = detail::AppendBlobString( blob, operand->GetDescription().c_str() );
+            }
+            std::memcpy( &blob[sizeof( detail::BlobHeader ) + k * sizeof( detail::BlobRecord )],
+                         &record, sizeof( detail::BlobRecord ) );
+        }
+        header.arguments = detail::AlignBlob( blob );
+        blob.append( header.nbArguments * sizeof( unsigned int ), '\0' );
+        for( unsigned int k = 0; k < header.nbArguments; k++ )
+        {
+            unsigned int offset = detail::AppendBlobString( blob, this->argv[first + k] );
+            std::memcpy( &blob[header.arguments + k * sizeof( unsigned int )], &offset, sizeof( unsigned int ) );
+        }
+        blob += '\0'; // the blob ends with a null character, see ResultView::Attach()
+        header.size = detail::AlignBlob( blob );
+        header.valid = this->IsCommandLineValid() ? 1 : 0;
+        std::memcpy( &blob[0], &header, sizeof( detail::BlobHeader ) );
+        YAAP_STATS( this->stats.bytesCopied += blob.size(); )
+    };
+
+    //! Get the usage text. It is rendered once, then kept until an option,
+    //! a subcommand, the description or an error flag changes.
+    const std::string& GetUsage( )
+    {
+        bool valid = this->usageValid && this->usageErrors.size() == this->optionVector.size();
+        for( unsigned int i = 0; valid && i < this->optionVector.size(); i++ )
+            valid = ( this->usageErrors[i] != 0 ) == this->optionVector[i]->ErrorFlag();
+        if( valid )
+            return( this->usageText );
+
+        YAAP_STATS( detail::StatsTimer timer( this->stats.usageNs ); )
+        std::string& out = this->usageText;
+        out.clear();
+        detail::AppendUsageHeader( out, this->argv[0], this->description.c_str() );
+        if( !this->subcommand.empty() )
+            ( out += ' ' ) += this->subcommand;
+        else if( !this->subcommandVector.empty() )
+            out += " <subcommand>";
+        for( unsigned int i = 0; i < optionVector.size(); i++ )
+            optionVector[i]->CLUsage( out );
+        out += '\n';
+
+        this->usageErrors.resize( this->optionVector.size() );
+        for( unsigned int i = 0; i < optionVector.size(); i++ )
+        {
+            this->usageErrors[i] = optionVector[i]->ErrorFlag();
+            detail::AppendOptionLine( out, optionVector[i]->ErrorFlag(), optionVector[i]->Flag(),
+                                      optionVector[i]->LongName().c_str(),
+                                      optionVector[i]->GetDescription().c_str(),
+                                      optionVector[i]->IsRequired() );
+        }
+        if( this->subcommand.empty() && !this->subcommandVector.empty() )
+        {
+            out += "Subcommands:\n";
+            for( unsigned int i = 0; i < this->subcommandVector.size(); i++ )
+                ( ( ( ( out += '\t' ) += this->subcommandVector[i].first ) += " : " )
+                    += this->subcommandVector[i].second ) += '\n';
+        }
+        detail::AppendUsageFooter( out );
+        this->usageValid = true;
+        YAAP_STATS( this->stats.bytesCopied += out.size(); )
+        return( out );
+    };
+
+    //! Print the usage on the standard output, with a single write
+    void Usage( )
+    {
+        detail::WriteOut( this->GetUsage() );
+    };
+
+#ifndef YAAP_NO_IOSTREAM
+    //! Write the usage on out
+    void Usage( std::ostream& out )
+    {
+        const std::string& text = this->GetUsage();
+        out.write( text.data(), static_cast<std::streamsize>( text.size() ) );
+    };
+#endif
+
+    //! Copy the usage in buffer, truncated to size-1 characters and
+    //! null-terminated (as snprintf). \return the length of the whole usage
+    std::size_t Usage( char* buffer, std::size_t size )
+    {
+        const std::string& text = this->GetUsage();
+        if( size > 0 )
+        {
+            std::size_t length = text.size() < size - 1 ? text.size() : size - 1;
+            std::memcpy( buffer, text.data(), length );
+            buffer[length] = '\0';
+        }
+        return( text.size() );
+    };
+
+    bool IsCommandLineValid( )
+    {
+        return( !this->error );
+    };
+
+    //! Errors found so far, in order of detection
+    const ErrorBuffer& Errors( ) const
+    {
+        return( this->errors );
+    };
+
+    //! If lazy is true, the options added afterwards do not convert their
+    //! arguments at parse time but at the first access to their values.
+    //! Conversion errors are then reported only after Validate().
+    void SetLazyConversion( bool lazy )
+    {
+        this->lazy = lazy;
+    };
+
+    //! When option is present, required must be present too. Checked by Validate().
+    void Requires( Option* option, Option* required )
+    {
+        std::vector<Option*> group( 1, required );
+        this->AddConstraint( Constraint::Requires, option, group );
+    };
+
+    //! option and excluded must not be present together. Checked by Validate().
+    void Excludes( Option* option, Option* excluded )
+    {
+        std::vector<Option*> group( 1, excluded );
+        this->AddConstraint( Constraint::Excludes, option, group );
+    };
+
+    //! At least one of the options of group must be present. Checked by Validate().
+    void AtLeastOneOf( const std::vector<Option*>& group ) {
+        this->AddConstraint( Constraint::AtLeastOne, NULL, group );
+    };
+
+    //! At most one of the options of group may be present. Checked by Validate().
+    void AtMostOneOf( const std::vector<Option*>& group ) {
+        this->AddConstraint( Constraint::AtMostOne, NULL, group );
+    };
+
+    //! Convert the pending arguments of all the options, then check the
+    //! ranges and choices of their values and the constraints between them
+    //! (Requires(), Excludes(), AtLeastOneOf(), AtMostOneOf()). Relations
+    //! are checked as bit masks over the set of present options.
+    //! \return IsCommandLineValid()
+    bool Validate( )
+    {
+        YAAP_STATS( detail::StatsTimer timer( this->stats.conversionNs ); )
+        std::vector<const char*> failures;
+        for( unsigned int i = 0; i < this->optionVector.size(); i++ )
+        {
+            Option* option = this->optionVector[i];
+            option->Validate();
+            failures.clear();
+            option->TakeFailures( failures );
+            for( std::size_t f = 0; f < failures.size(); f++ )
+            {
+                // locate the character that failed in the command line
+                const char* position = failures[f];
+                unsigned int argIndex = 0;
+                for( unsigned int k = 1; argIndex == 0 && k < this->nbArgs; k++ )
+                    if( !std::less<const char*>()( position, this->argv[k] )
+                     && !std::less<const char*>()( this->argv[k] + std::strlen( this->argv[k] ), position ) )
+                        argIndex = k;
+                this->RecordError( Error::BadValue, argIndex, argIndex ? position : NULL, option, i );
+            }
+        }
+        if( !this->constraintsChecked )
+        {
+            this->CheckConstraints( );
+            this->constraintsChecked = true;
+        }
+        return( this->IsCommandLineValid() );
+    };
+
+    //! \name Edition of the command line
+    //! For an interactive console that checks a command line while it is
+    //! typed: the argument at index (1 to argc - 1) is replaced, or a new one
+    //! is inserted before it (index argc to append), or it is removed. The
+    //! command line is indexed again, but only the options whose flag or long
+    //! name is in the argument changed, or whose option-arguments span it, are
+    //! parsed and converted again; the errors of the other ones are kept,
+    //! their argument indices moved. The operands are set again.
+    //! The new arguments are copied, and the copies of the arguments replaced
+    //! or erased are released with the values that point into them (e.g.
+    //! std::string_view). A subcommand is not selected again.
+    //! \return Validate(), or false without any change if index is out of range
+    //! \{
+    bool Update( unsigned int index, const char* arg )
+    {
+        if( index == 0 || index >= this->nbArgs )
+            return( false );
+        this->Edit( index, arg, 0 );
+        return( this->Validate() );
+    };
+
+    bool Insert( unsigned int index, const char* arg )
+    {
+        if( index == 0 || index > this->nbArgs )
+            return( false );
+        this->Edit( index, arg, 1 );
+        return( this->Validate() );
+    };
+
+    bool Erase( unsigned int index )
+    {
+        if( index == 0 || index >= this->nbArgs )
+            return( false );
+        this->Edit( index, NULL, -1 );
+        return( this->Validate() );
+    };
+    //! \}
+
+    void SetDescription( std::string desc )
+    {
+        this->description = desc;
+        this->usageValid = false;
+    };
+
+    //! Counters of the work done so far, all 0 unless YAAP_ENABLE_STATS is
+    //! defined. With it, "--yaap-stats" in the command line prints them on
+    //! the standard error when the parser is destroyed.
+    ParserStats Stats( ) const
+    {
+        ParserStats current = this->stats;
+        current.allocations = this->arena.GetNumberOfAllocations();
+        current.heapBlocks = this->arena.GetNumberOfBlocks();
+        return( current );
+    };
+
+    //! Print Stats() on file
+    void PrintStats( std::FILE* file = stderr ) const
+    {
+        ParserStats current = this->Stats();
+        std::fprintf( file,
+                      "yaap stats:\n"
+                      "  constructor      %12.3f us\n"
+                      "  add options      %12.3f us (%u calls)\n"
+                      "  conversions      %12.3f us (%llu bytes)\n"
+                      "  usage            %12.3f us\n"
+                      "  argv scans       %12u\n"
+                      "  allocations      %12u (%u heap blocks)\n"
+                      "  bytes copied     %12llu\n",
+                      current.constructorNs / 1000.0, current.addOptionNs / 1000.0, current.nbAddOptions,
+                      current.conversionNs / 1000.0, current.bytesConverted, current.usageNs / 1000.0,
+                      current.argvScans, current.allocations, current.heapBlocks, current.bytesCopied );
+    };
+
+private:
+    enum { MaxDepth = 16 }; //!< maximum nesting of response files
+
+    //! Set up the parser for the command line argv, see Parser()
+    void Initialize( int argc, char** argv, const std::string& description )
+    {
+        std::memset( &this->stats, 0, sizeof( ParserStats ) );
+
+        this->dumpStats = false;
+        YAAP_STATS( detail::StatsTimer timer( this->stats.constructorNs ); )
+        this->nbArgs = argc;
+        this->argv = argv;
+        this->error = false;
+        this->lazy = false;
+        this->description = description;
+        this->completing = false;
+        this->completionWord = "";
+        this->usageValid = false;
+        this->constraintsChecked = false;
+        this->maxSpan = 0;
+        if( argc >= 2 && std::strcmp( argv[1], "--yaap-complete-script" ) == 0 )
+        {
+            this->completing = true;
+            this->completionShell = argc >= 3 ? argv[2] : "bash";
+            this->nbArgs = 1;
+        }
+        else if( argc >= 2 && std::strcmp( argv[1], "--yaap-complete" ) == 0 )
+        {
+            // parse the words already typed, as "utility word1 ..."; the
+            // last word is the one to complete
+            this->completing = true;
+            this->completionWord = argc >= 3 ? argv[argc - 1] : "";
+            std::vector<char*> words( 1, argv[0] );
+            for( int argId = 2; argId < argc - 1; argId++ )
+                words.push_back( argv[argId] );
+            words.push_back( NULL );
+            this->arguments.swap( words );
+            this->argv = &this->arguments[0];
+            this->nbArgs = static_cast<unsigned int>( this->arguments.size() - 1 );
+        }
+#ifdef YAAP_ENABLE_STATS
+        // "--yaap-stats" prints the statistics on the standard error at the end
+        std::vector<char*> kept;
+        for( unsigned int argId = 0; argId < this->nbArgs; argId++ )
+            if( std::strcmp( this->argv[argId], "--yaap-stats" ) == 0 )
+                this->dumpStats = true;
+            else
+                kept.push_back( this->argv[argId] );
+        this->stats.argvScans++;
+        if( this->dumpStats )
+        {
+            kept.push_back( NULL );
+            this->arguments.swap( kept );
+            this->argv = &this->arguments[0];
+            this->nbArgs = static_cast<unsigned int>( this->arguments.size() - 1 );
+        }
+#endif
+        this->Tokenize( );
+    };
+
+
+    //! Encode the wide command line argv in UTF-8 into a single arena
+    //! buffer. \return the encoded argument vector, kept in arguments
+    template<typename Unit>
+    char** EncodeArguments( int argc, Unit** argv )
+    {
+        std::vector<std::size_t> lengths( argc > 0 ? argc : 0 );
+        std::size_t total = 0;
+        for( int argId = 0; argId < argc; argId++ )
+        {
+            const Unit* last = argv[argId];
+            while( *last != 0 )
+                last++;
+            lengths[argId] = static_cast<std::size_t>( last - argv[argId] );
+            total += detail::Utf8Length( static_cast<const Unit*>( argv[argId] ), last ) + 1;
+        }
+        char* out = static_cast<char*>( this->arena.Allocate( total ) );
+        this->arguments.resize( lengths.size() + 1 );
+        for( int argId = 0; argId < argc; argId++ )
+        {
+            this->arguments[argId] = out;
+            out = detail::EncodeUtf8( static_cast<const Unit*>( argv[argId] ), argv[argId] + lengths[argId], out );
+            *out++ = '\0';
+        }
+        this->arguments[lengths.size()] = NULL;
+        return( &this->arguments[0] );
+    };
+
+    //! Find the operand offset and build the tokenizer tables
+    void Tokenize( )
+    {
+        YAAP_STATS( this->stats.argvScans++; ) // tokenizer tables
+        this->FindOperandOffset( );
+        this->tokenizer.Tokenize( this->nbArgs, this->argv );
+    };
+
+    //! Find the first possible operand
+    void FindOperandOffset( )
+    {
+        YAAP_STATS( this->stats.argvScans++; )
+        this->operandOffset = 1; // Case with no option
+        this->delimited = false;
+        // find the first possible operand (use of "--" flag)
+        for( unsigned int argId = 0; argId < this->nbArgs; argId++ )
+        {
+            if( this->argv[argId][0] == '-' )
+                if( this->argv[argId][1] == '-' )
+                    if( this->argv[argId][2] == '\0' )
+                    {
+                        this->operandOffset = argId+1;
+                        this->delimited = true;
+                    }
+        }
+    };
+
+    //! Append arg, or the arguments of the response file it names, to expanded
+    bool Expand( char* arg, unsigned int depth, std::vector<char*>& expanded )
+    {
+        if( arg[0] != '@' || arg[1] == '\0' || depth >= MaxDepth )
+        {
+            expanded.push_back( arg );
+            return( true );
+        }
+        ResponseFile file;
+        std::vector<char*> fileArguments;
+        if( !this->LoadResponseFile( arg + 1, file, fileArguments ) )
+        {
+            expanded.push_back( arg );
+            return( false );
+        }
+        this->responseFiles.push_back( file );
+        bool success = true;
+        for( std::size_t k = 0; k < fileArguments.size(); k++ )
+            if( !this->Expand( fileArguments[k], depth + 1, expanded ) )
+                success = false;
+        return( success );
+    };
+
+    //! Read and tokenize the response file path, or take it from Prefetch()
+    //! \return false if it cannot be read
+    bool LoadResponseFile( const char* path, ResponseFile& file, std::vector<char*>& fileArguments )
+    {
+#ifdef YAAP_HAS_THREADS
+        for( std::size_t k = 0; k < this->pendingFiles.size(); k++ )
+        {
+            PendingFile* pending = this->pendingFiles[k];
+            if( pending->taken || pending->path != path )
+                continue;
+            pending->taken = true;
+            if( !pending->ready.get() )
+                return( false );
+            file = pending->file;
+            fileArguments.swap( pending->fileArguments );
+            return( true );
+        }
+#endif
+        if( !file.Load( path ) )
+            return( false );
+        file.Tokenize( fileArguments );
+        return( true );
+    };
+
+    //! Fill settings from the configuration file path, see SetConfigFile()
+    static bool LoadConfiguration( const std::string& path, const std::string& snapshotPath, Settings& settings )
+    {
+        settings.Clear();
+        unsigned long long stamp[Settings::StampSize] = { 0, 0, 0, 0, 0, 0 };
+        bool stamped = false;
+        bool fresh = false; // true if the snapshot was written after the last change of path
+#ifdef YAAP_HAS_MMAP
+        struct stat status;
+        if( ::stat( path.c_str(), &status ) != 0 )
+            return( false );
+        // an edit keeping the size changes the times, to the nanosecond
+        // where the file system has them, and a replaced file has another inode
+        stamp[0] = static_cast<unsigned long long>( status.st_mtime );
+        stamp[1] = static_cast<unsigned long long>( YAAP_MTIME_NSEC( status ) );
+        stamp[2] = static_cast<unsigned long long>( status.st_ctime );
+        stamp[3] = static_cast<unsigned long long>( YAAP_CTIME_NSEC( status ) );
+        stamp[4] = static_cast<unsigned long long>( status.st_size );
+        stamp[5] = static_cast<unsigned long long>( status.st_ino );
+        stamped = true;
+        // the clock of the file system may not tell apart an edit made in
+        // the tick the snapshot was written: such a snapshot is not trusted
+        struct stat snapshot;
+        fresh = !snapshotPath.empty() && ::stat( snapshotPath.c_str(), &snapshot ) == 0
+             && ( snapshot.st_mtime > status.st_mtime
+               || ( snapshot.st_mtime == status.st_mtime && YAAP_MTIME_NSEC( snapshot ) > YAAP_MTIME_NSEC( status ) ) );
+#endif
+        if( fresh && settings.Load( snapshotPath.c_str(), stamp ) )
+            return( true );
+        ResponseFile file;
+        if( !file.Load( path.c_str() ) )
+            return( false );
+        settings.ParseConfiguration( file.Data(), file.Data() + file.Size() );
+        file.Release();
+        settings.Sort();
+        if( stamped && !snapshotPath.empty() )
+            settings.Save( snapshotPath.c_str(), stamp );
+        return( true );
+    };
+
+#ifdef YAAP_HAS_THREADS
+    //! Response file read by a background thread, see Prefetch()
+    struct PendingFile {
+        std::string path; //!< name of the file, without the '@'
+        ResponseFile file; //!< content of the file, once ready
+        std::vector<char*> fileArguments; //!< arguments tokenized in file
+        std::future<bool> ready; //!< false if the file cannot be read
+        bool taken; //!< true once ExpandResponseFiles() took the file
+    };
+
+    //! If true, Prefetch() reads the response file path and it is not taken yet
+    bool IsPending( const char* path ) const
+    {
+        for( std::size_t k = 0; k < this->pendingFiles.size(); k++ )
+            if( !this->pendingFiles[k]->taken && this->pendingFiles[k]->path == path )
+                return( true );
+        return( false );
+    };
+
+    //! Run task in a new thread or, if none can be started, when its
+    //! result is needed
+    template<class Task>
+    static std::future<bool> Start( Task task )
+    {
+        try {
+            return( std::async( std::launch::async, task ) );
+        }
+        catch( const std::system_error& ) {
+            return( std::async( std::launch::deferred, task ) );
+        }
+    };
+
+    static bool IsReady( const std::future<bool>& result )
+    {
+        return( result.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready );
+    };
+#endif
+
+    //! How to parse an option again, see Edit()
+    typedef void ( Parser::*Resolver )( Option* option, unsigned int id );
+
+    //! Definition of an option, by order of addition
+    struct Resolution {
+        Resolver resolve; //!< ResolveOption() or ResolveOptionArg<T>()
+        bool hasArgs; //!< true for an OptionArg
+        unsigned int nbsubargs; //!< number of option-arguments, yaap::undef for a comma list
+    };
+
+    void AddResolution( Resolver resolve, bool hasArgs, unsigned int nbsubargs )
+    {
+        Resolution resolution = { resolve, hasArgs, nbsubargs };
+        this->resolutions.push_back( resolution );
+        unsigned int span = hasArgs ? ( nbsubargs == yaap::undef ? 1 : nbsubargs ) : 0;
+        if( span > this->maxSpan )
+            this->maxSpan = span;
+    };
+
+    //! Mark the options whose flag or long name is in arg
+    void MarkMentions( const char* arg )
+    {
+        if( arg[0] != '-' )
+            return;
+        for( unsigned int c = 1; arg[c] != '\0' && arg[c] != '-'; c++ )
+        {
+            unsigned int id = this->optionIndex.Find( arg[c] );
+            if( id != OptionIndex::npos )
+                this->affected[id] = 1;
+        }
+        if( arg[1] == '-' && arg[2] != '\0' )
+        {
+            unsigned int id = this->optionIndex.Find( arg + 2 );
+            if( id != OptionIndex::npos )
+                this->affected[id] = 1;
+        }
+    };
+
+    //! Replace (delta 0), insert (delta 1) or erase (delta -1) the argument
+    //! at index, then parse again the options it affects, see Update()
+    void Edit( unsigned int index, const char* arg, int delta )
+    {
+        unsigned int nbOptions = static_cast<unsigned int>( this->optionVector.size() );
+        // the options are found from the arguments before the edition: by
+        // name in the old and the new argument, or by the option-arguments
+        // spanning index, which begin at most maxSpan arguments before
+        this->affected.assign( nbOptions, 0 );
+        if( delta <= 0 )
+            this->MarkMentions( this->argv[index] );
+        if( arg != NULL )
+            this->MarkMentions( arg );
+        for( unsigned int i = index > this->maxSpan ? index - this->maxSpan : 1; i < index; i++ )
+        {
+            const char* previous = this->argv[i];
+            if( previous[0] != '-' )
+                continue;
+            unsigned int id = previous[1] == '-' ? ( previous[2] != '\0' ? this->optionIndex.Find( previous + 2 ) : OptionIndex::npos )
+                                                 : this->optionIndex.Find( previous[1] );
+            if( id == OptionIndex::npos || !this->resolutions[id].hasArgs )
+                continue;
+            unsigned int nbsubargs = this->resolutions[id].nbsubargs;
+            if( i + ( nbsubargs == yaap::undef ? 1 : nbsubargs ) >= index )
+                this->affected[id] = 1;
+        }
+        // optionIndex does not lead to the options of a reserved or duplicate
+        // flag, and the error flags raised by the constraints are raised
+        // again by Validate()
+        for( std::size_t k = 0; k < this->unindexedOptions.size(); k++ )
+            this->affected[this->unindexedOptions[k]] = 1;
+        for( std::size_t k = 0; k < this->flaggedOptions.size(); k++ )
+            this->affected[this->flaggedOptions[k]] = 1;
+        this->flaggedOptions.clear();
+        if( this->errors.Dropped() > 0 ) // the errors of any option may be lost
+            this->affected.assign( nbOptions, 1 );
+
+        // edit a copy of the argument vector
+        if( this->arguments.empty() || this->argv != &this->arguments[0] )
+        {
+            this->arguments.assign( this->argv, this->argv + this->nbArgs );
+            this->arguments.push_back( NULL );
+        }
+        char* removed = delta <= 0 ? this->arguments[index] : NULL;
+        char* copy = NULL;
+        if( arg != NULL )
+        {
+            std::size_t length = std::strlen( arg );
+            copy = new char[length + 1];
+            std::memcpy( copy, arg, length + 1 );
+            this->editedArguments.push_back( copy );
+        }
+        if( delta == 0 )
+            this->arguments[index] = copy;
+        else if( delta > 0 )
+            this->arguments.insert( this->arguments.begin() + index, copy );
+        else
+            this->arguments.erase( this->arguments.begin() + index );
+        this->argv = &this->arguments[0];
+        this->nbArgs = static_cast<unsigned int>( this->arguments.size() - 1 );
+        this->tokenizer.Edit( index, removed, copy, delta );
+        // the operands move with the arguments, unless a "--" is edited
+        unsigned int firstOperand = this->operandOffset - static_cast<unsigned int>( this->operandVector.size() );
+        if( ( removed != NULL && std::strcmp( removed, "--" ) == 0 ) || ( copy != NULL && std::strcmp( copy, "--" ) == 0 ) )
+        {
+            this->FindOperandOffset( );
+            if( !this->subcommand.empty() && this->operandOffset == 1 )
+                this->operandOffset = 2;
+        }
+        else
+            this->operandOffset = index < firstOperand ? firstOperand + delta : firstOperand;
+        this->ReleaseArgument( removed );
+
+        // keep the errors of the other options, at their new index
+        ErrorBuffer kept;
+        for( std::size_t k = 0; k < this->errors.size(); k++ )
+        {
+            Error record = this->errors[k];
+            bool derived = record.code == Error::MissingOperand || record.code == Error::BadOperand
+                        || IsConstraintError( record.code ); // found again by Validate()
+            if( derived || ( record.option != NULL && this->affected[record.id] ) )
+                continue;
+            if( record.code != Error::UnreadableFile && record.argIndex != 0 && record.argIndex >= index
+             && !( delta < 0 && record.argIndex == index ) )
+                record.argIndex = static_cast<unsigned int>( static_cast<int>( record.argIndex ) + delta );
+            kept.Push( record );
+        }
+        this->errors = kept;
+        this->error = !this->errors.empty();
+        this->constraintsChecked = false;
+
+        for( unsigned int id = 0; id < nbOptions; id++ )
+        {
+            if( !this->affected[id] )
+                continue;
+            Option* option = this->optionVector[id];
+            option->Reset();
+            ( this->*this->resolutions[id].resolve )( option, id );
+            this->CheckDefinition( option, id );
+            this->CheckRequired( option, id );
+        }
+        for( std::size_t k = 0; k < this->operandVector.size(); k++ )
+            this->ResolveOperand( this->operandVector[k], k );
+    };
+
+    //! Release the copy of an edited argument, if arg is one
+    void ReleaseArgument( char* arg )
+    {
+        std::vector<char*>::iterator it = std::find( this->editedArguments.begin(), this->editedArguments.end(), arg );
+        if( it == this->editedArguments.end() )
+            return;
+        delete[] *it;
+        this->editedArguments.erase( it );
+    };
+
+    //! Raise again the errors of PushOption() for the option id
+    void CheckDefinition( Option* option, unsigned int id )
+    {
+        if( option->Flag() == 'W' || option->Flag() == '-' )
+        {
+            option->RaiseError( );
+            this->RecordError( Error::ReservedFlag, 0, NULL, option, id );
+        }
+        else if( ( option->Flag() != '\0' && this->optionIndex.Find( option->Flag() ) != id )
+              || ( !option->LongName().empty() && this->optionIndex.Find( option->LongName() ) != id ) )
+        {
+            option->RaiseError( );
+            this->RecordError( Error::DuplicateOption, 0, NULL, option, id );
+        }
+    };
+
+    void PushOption( Option* option ){
+        this->usageValid = false;
+        this->constraintsChecked = false;
+        unsigned int id = static_cast<unsigned int>( this->optionVector.size() );
+        this->optionVector.push_back( option );
+        // Reserved POSIX flags
+        if( option->Flag() == 'W' || option->Flag() == '-' )
+        {
+            option->RaiseError( );
+            this->RecordError( Error::ReservedFlag, 0, NULL, option, id );
+            this->unindexedOptions.push_back( id );
+        }
+        // Flag or long name already used by another option
+        else if( !this->optionIndex.Insert( option->Flag(), option->LongName(), id ) )
+        {
+            option->RaiseError( );
+            this->RecordError( Error::DuplicateOption, 0, NULL, option, id );
+            this->unindexedOptions.push_back( id );
+        }
+    };
+
+    //! Relation between options, see Requires()
+    struct Constraint {
+        enum Kind { Requires, Excludes, AtLeastOne, AtMostOne };
+        Kind kind;
+        unsigned int subject; //!< option of Requires and Excludes
+        std::vector<unsigned long> mask; //!< bit set of the other options
+    };
+
+    enum { WordBits = std::numeric_limits<unsigned long>::digits };
+
+    //! Index of option in optionVector, or npos
+    unsigned int IndexOf( const Option* option ) const
+    {
+        for( unsigned int id = 0; id < this->optionVector.size(); id++ )
+            if( this->optionVector[id] == option )
+                return( id );
+        return( OptionIndex::npos );
+    };
+
+    void AddConstraint( Constraint::Kind kind, Option* subject, const std::vector<Option*>& group )
+    {
+        Constraint constraint;
+        constraint.kind = kind;
+        constraint.subject = subject ? this->IndexOf( subject ) : OptionIndex::npos;
+        constraint.mask.assign( ( this->optionVector.size() + WordBits - 1 ) / WordBits, 0 );
+        for( std::size_t k = 0; k < group.size(); k++ )
+        {
+            unsigned int id = this->IndexOf( group[k] );
+            if( id != OptionIndex::npos )
+                constraint.mask[id / WordBits] |= 1UL << ( id % WordBits );
+        }
+        this->constraints.push_back( constraint );
+        this->constraintsChecked = false;
+    };
+
+    //! If true, code is an error found by CheckConstraints()
+    static bool IsConstraintError( Error::Code code )
+    {
+        return( code == Error::OutOfRange || code == Error::InvalidChoice || code == Error::MissingDependency
+             || code == Error::Conflict || code == Error::MissingAlternative );
+    };
+
+    //! Check the values of the options then the constraints, once all the
+    //! options are converted
+    void CheckConstraints( )
+    {
+        // drop the errors of a previous check, found again below
+        ErrorBuffer kept;
+        for( std::size_t k = 0; k < this->errors.size(); k++ )
+            if( !IsConstraintError( this->errors[k].code ) )
+                kept.Push( this->errors[k] );
+        if( kept.size() != this->errors.size() )
+        {
+            this->error = !kept.empty() || this->errors.Dropped() > 0;
+            this->errors = kept;
+        }
+        for( unsigned int id = 0; id < this->optionVector.size(); id++ )
+        {
+            unsigned int pos;
+            Option::ValueCheck check = this->optionVector[id]->CheckValues( pos );
+            if( check != Option::ValuesOk )
+            {
+                this->flaggedOptions.push_back( id );
+                this->RecordError( check == Option::ValueOutOfRange ? Error::OutOfRange : Error::InvalidChoice,
+                                   0, NULL, this->optionVector[id], id );
+            }
+        }
+        if( this->constraints.empty() )
+            return;
+        std::vector<unsigned long> present( ( this->optionVector.size() + WordBits - 1 ) / WordBits, 0 );
+        for( unsigned int id = 0; id < this->optionVector.size(); id++ )
+            if( this->optionVector[id]->Exists() )
+                present[id / WordBits] |= 1UL << ( id % WordBits );
+        for( std::size_t c = 0; c < this->constraints.size(); c++ )
+        {
+            const Constraint& constraint = this->constraints[c];
+            unsigned int hits = 0; // present options of the mask
+            bool all = true; // all the options of the mask are present
+            for( std::size_t w = 0; w < constraint.mask.size(); w++ )
+            {
+                unsigned long common = present[w] & constraint.mask[w];
+                all = all && common == constraint.mask[w];
+                for( ; common != 0; common &= common - 1 )
+                    hits++;
+            }
+            bool subject = constraint.subject != OptionIndex::npos
+                        && ( ( present[constraint.subject / WordBits] >> ( constraint.subject % WordBits ) ) & 1 );
+            bool violated = false;
+            Error::Code code = Error::Conflict;
+            switch( constraint.kind )
+            {
+                case Constraint::Requires:   violated = subject && !all; code = Error::MissingDependency; break;
+                case Constraint::Excludes:   violated = subject && hits > 0; break;
+                case Constraint::AtLeastOne: violated = hits == 0; code = Error::MissingAlternative; break;
+                case Constraint::AtMostOne:  violated = hits > 1; break;
+            }
+            if( !violated )
+                continue;
+            // mark the subject, or the options of the group involved
+            unsigned int reported = constraint.subject;
+            for( unsigned int id = 0; id < this->optionVector.size(); id++ )
+            {
+                bool member = id / WordBits < constraint.mask.size()
+                           && ( ( constraint.mask[id / WordBits] >> ( id % WordBits ) ) & 1 );
+                bool marked = id == constraint.subject
+                           || ( constraint.subject == OptionIndex::npos && member
+                             && ( constraint.kind == Constraint::AtLeastOne || this->optionVector[id]->Exists() ) );
+                if( !marked )
+                    continue;
+                this->optionVector[id]->RaiseError();
+                this->flaggedOptions.push_back( id );
+                if( reported == OptionIndex::npos )
+                    reported = id;
+            }
+            if( reported != OptionIndex::npos )
+                this->RecordError( code, 0, NULL, this->optionVector[reported], reported );
+            else
+                this->RecordError( code, 0, NULL, NULL, 0 );
+        }
+    };
+
+    //! Implementation of AddOptionArg(), binding the option to values (see
+    //! OptionArg::Bind()) if not NULL
+    template<class T>
+    OptionArg<T>* ParseOptionArg( char flag, std::string longName, std::string description, unsigned int nbsubargs,
+                                  bool required, T* values, std::size_t nbValues )
+    {
+        YAAP_STATS( detail::StatsTimer timer( this->stats.addOptionNs ); )
+        YAAP_STATS( this->stats.nbAddOptions++; )
+        // option allocation
+        OptionArg<T>* option = new( this->arena.Allocate( sizeof( OptionArg<T> ) ) )
+                               OptionArg<T>( flag, longName, description, nbsubargs );
+        option->SetRequired( required);
+        option->SetLazyConversion( this->lazy );
+        if( values != NULL )
+            option->Bind( values, nbValues );
+        unsigned int id = static_cast<unsigned int>( this->optionVector.size() );
+        this->AddResolution( &Parser::ResolveOptionArg<T>, true, nbsubargs );
+        this->ResolveOptionArg<T>( option, id );
+        // Put the Option in the options' array.
+        this->PushOption( option );
+        // if required but not found, raise an error
+        this->CheckRequired( option, id );
+        // Return the created Option for the user to use it in the main program
+        return( option );
+    };
+
+    //! If false, option id has a reserved flag or a flag or long name of
+    //! another option (see PushOption()), and never matches the command line
+    bool OwnsNames( Option* option, unsigned int id ) const
+    {
+        char flag = option->Flag();
+        if( flag == 'W' || flag == '-' )
+            return( false );
+        unsigned int owner = flag == '\0' ? OptionIndex::npos : this->optionIndex.Find( flag );
+        if( owner != OptionIndex::npos && owner != id )
+            return( false );
+        owner = option->LongName().empty() ? OptionIndex::npos : this->optionIndex.Find( option->LongName() );
+        return( owner == OptionIndex::npos || owner == id );
+    };
+
+    //! Find the occurrences of option, a simple option, in the command line
+    void ResolveOption( Option* option, unsigned int id )
+    {
+        if( !this->OwnsNames( option, id ) )
+            return;
+        // The option flag can be concatenated after a unique '-', and each
+        // occurrence is counted ("-vvv")
+        option->AddOccurrences( this->tokenizer.FlagEnd( option->Flag() ) - this->tokenizer.FlagBegin( option->Flag() ) );
+        unsigned int first, last;
+        this->tokenizer.LongRange( option->LongName(), first, last );
+        option->AddOccurrences( last - first );
+        // else fall back on the environment and the configuration file
+        const char* value = option->Exists() ? NULL : this->Fallback( option->LongName() );
+        if( value != NULL && detail::IsTrue( value ) )
+            option->AddOccurrences( 1 );
+    };
+
+    //! Find the occurrences of the OptionArg<T> base in the command line and
+    //! convert their arguments
+    template<class T>
+    void ResolveOptionArg( Option* base, unsigned int id )
+    {
+        OptionArg<T>* option = static_cast<OptionArg<T>*>( base );
+        if( !this->OwnsNames( option, id ) )
+            return;
+        unsigned int nbsubargs = this->resolutions[id].nbsubargs;
+        char flag = option->Flag();
+        std::string longName = option->LongName();
+
+        // Merge, in command line order, the '-f' and '--longName' occurrences
+        std::vector<unsigned int> occurrences;
+        unsigned int f = this->tokenizer.FlagBegin( flag );
+        unsigned int fEnd = this->tokenizer.FlagEnd( flag );
+        unsigned int l, lEnd;
+        this->tokenizer.LongRange( longName, l, lEnd );
+        while( f != fEnd || l != lEnd )
+        {
+            if( f != fEnd && this->tokenizer.FlagToken( f ).charId != 1 )
+            {
+                f++; // the flag is not the first of its cluster
+                continue;
+            }
+            if( l == lEnd || ( f != fEnd && this->tokenizer.FlagToken( f ).argId
+                                            < this->tokenizer.GetLongToken( l ).argId ) )
+                occurrences.push_back( this->tokenizer.FlagToken( f++ ).argId );
+            else
+                occurrences.push_back( this->tokenizer.GetLongToken( l++ ).argId );
+        }
+
+        YAAP_STATS( unsigned long long conversionStart = detail::StatsClock(); )
+        option->ReserveOccurrences( occurrences.size() );
+        for( unsigned int occ = 0; occ < occurrences.size(); occ++ )
+        {
+            unsigned int i = occurrences[occ];
+            // toggle the state of the option to true
+            option->BeginOccurrence();
+            // a comma list (yaap::undef) is a single option-argument
+            if( i + ( nbsubargs == yaap::undef ? 1 : nbsubargs ) >= this->nbArgs )
+            {
+                option->RaiseError();
+                this->RecordError( Error::MissingArgument, i, NULL, option, id );
+            }
+            else
+            {
+              // If nb of option-arguments is unknown, get the arguments
+              // with comma-separated split
+              if( nbsubargs == yaap::undef )
+              {
+                const char* arg = argv[i + 1];
+                const char* end = arg + std::strlen( arg );
+                YAAP_STATS( this->stats.bytesConverted += end - arg; )
+                option->ReserveArguments( detail::CountByte( arg, end, ',' ) + 1 );
+                while( arg != end )
+                {
+                  const char* comma = detail::FindByte( arg, end, ',' );
+                  const char* stop = option->AddArgument( arg, comma );
+                  if( stop != comma )
+                    this->RecordError( option->Overflowed() ? Error::TooManyValues : Error::BadValue, i + 1, stop, option, id );
+                  arg = ( comma == end ) ? end : comma + 1;
+                }
+              }
+              else
+              {
+                for( unsigned int argIdx = 1; argIdx <= nbsubargs; argIdx++ )
+                {
+                  // For each sub-argument, memorize the command line value in
+                  // the OptionArg object
+                  const char* arg = argv[i + argIdx];
+                  const char* end = arg + std::strlen( arg );
+                  YAAP_STATS( this->stats.bytesConverted += end - arg; )
+                  const char* stop = option->AddArgument( arg, end );
+                  if( stop != end )
+                    this->RecordError( option->Overflowed() ? Error::TooManyValues : Error::BadValue, i + argIdx, stop, option, id );
+                }
+
+              }
+            }
+        }
+        // else fall back on the environment and the configuration file
+        const char* value = occurrences.empty() ? this->Fallback( longName ) : NULL;
+        if( value != NULL )
+            this->AddFallbackArguments( option, id, nbsubargs, value );
+        YAAP_STATS( this->stats.conversionNs += detail::StatsClock() - conversionStart; )
+    };
+
+    //! Raise an error if option is required but not found
+    void CheckRequired( Option* option, unsigned int id )
+    {
+        if( !option->Exists() && option->IsRequired() )
+        {
+            option->RaiseError();
+            this->RecordError( Error::MissingRequired, 0, NULL, option, id );
+        }
+    };
+
+    //! Set the value of the operand op from the argument at operandOffset,
+    //! then move operandOffset to the next argument
+    void ResolveOperand( OperandBase* op, std::size_t id )
+    {
+        if( this->operandOffset >= this->nbArgs )
+        {
+            const char nullValue[] = "0";
+            op->SetValue( nullValue, nullValue + 1 );
+            this->RecordError( Error::MissingOperand, this->operandOffset, NULL, NULL, id );
+        }
+        else
+        {
+            YAAP_STATS( detail::StatsTimer timer( this->stats.conversionNs ); )
+            const char* arg = this->argv[this->operandOffset];
+            const char* end = arg + std::strlen( arg );
+            YAAP_STATS( this->stats.bytesConverted += end - arg; )
+            const char* stop = op->SetValue( arg, end );
+            // without "--", the operands are guessed from argv[1] and may
+            // well be options: only delimited operands must convert
+            if( stop != end && this->delimited )
+                this->RecordError( Error::BadOperand, this->operandOffset, stop, NULL, id );
+        }
+        this->operandOffset++;
+    };
+
+    //! Value of the option longName in the environment or, if none, in the
+    //! configuration file. \return NULL if none
+    const char* Fallback( const std::string& longName )
+    {
+        const char* value = NULL;
+        if( !this->environment.Empty() )
+        {
+            this->fallbackKey.clear();
+            for( std::size_t c = 0; c < longName.size(); c++ )
+                this->fallbackKey += longName[c] == '-' ? '_'
+                    : static_cast<char>( std::toupper( static_cast<unsigned char>( longName[c] ) ) );
+            value = this->environment.Find( this->fallbackKey.c_str() );
+        }
+        if( value == NULL && !this->configuration.Empty() && !this->subcommand.empty() )
+        {
+            ( ( this->fallbackKey = this->subcommand ) += '.' ) += longName;
+            value = this->configuration.Find( this->fallbackKey.c_str() );
+        }
+        if( value == NULL && !this->configuration.Empty() )
+            value = this->configuration.Find( longName.c_str() );
+        return( value );
+    };
+
+    //! Add the arguments of option found in a fall-back value: a comma list,
+    //! the whole value for a single argument or, for nbsubargs arguments,
+    //! words separated by white spaces
+    template<class T>
+    void AddFallbackArguments( OptionArg<T>* option, std::size_t id, unsigned int nbsubargs, const char* value )
+    {
+        option->BeginOccurrence();
+        const char* arg = value;
+        const char* end = value + std::strlen( value );
+        if( nbsubargs == yaap::undef )
+        {
+            option->ReserveArguments( detail::CountByte( arg, end, ',' ) + 1 );
+            while( arg != end )
+            {
+                const char* comma = detail::FindByte( arg, end, ',' );
+                const char* stop = option->AddArgument( arg, comma );
+                if( stop != comma )
+                    this->RecordError( option->Overflowed() ? Error::TooManyValues : Error::BadValue, 0, stop, option, id, value );
+                arg = ( comma == end ) ? end : comma + 1;
+            }
+            return;
+        }
+        if( nbsubargs == 1 )
+        {
+            const char* stop = option->AddArgument( arg, end );
+            if( stop != end )
+                this->RecordError( option->Overflowed() ? Error::TooManyValues : Error::BadValue, 0, stop, option, id, value );
+            return;
+        }
+        for( unsigned int argIdx = 0; argIdx < nbsubargs; argIdx++ )
+        {
+            while( arg != end && std::isspace( static_cast<unsigned char>( *arg ) ) )
+                arg++;
+            if( arg == end )
+            {
+                option->RaiseError();
+                this->RecordError( Error::MissingArgument, 0, NULL, option, id );
+                return;
+            }
+            const char* word = arg;
+            while( arg != end && !std::isspace( static_cast<unsigned char>( *arg ) ) )
+                arg++;
+            const char* stop = option->AddArgument( word, arg );
+            if( stop != arg )
+                this->RecordError( option->Overflowed() ? Error::TooManyValues : Error::BadValue, 0, stop, option, id, value );
+        }
+    };
+
+    //! Raise the error flag and record the error. stop, if not NULL, is the
+    //! first character that could not be converted, in argv[argIndex] or, for
+    //! a fall-back value, in base.
+    void RecordError( Error::Code code, unsigned int argIndex, const char* stop, const Option* option,
+                      std::size_t id, const char* base = NULL )
+    {
+        this->error = true;
+        Error record;
+        record.code = code;
+        record.argIndex = argIndex;
+        record.offset = stop ? static_cast<unsigned int>( stop - ( base ? base : this->argv[argIndex] ) ) : 0;
+        record.id = static_cast<unsigned int>( id );
+        record.option = option;
+        this->errors.Push( record );
+    };
+
+
+    unsigned int nbArgs; //!< Number of arguments (argc)
+    char** argv; //!< Arguments' vector
+    std::vector<Option*> optionVector; //!< vector of options
+    std::vector<Resolution> resolutions; //!< how to parse each option again, see Edit()
+    unsigned int maxSpan; //!< largest number of arguments an option takes
+    std::vector<char> affected; //!< options to parse again, see Edit()
+    std::vector<char*> editedArguments; //!< copies of the arguments given to Update() and Insert()
+    std::vector<unsigned int> unindexedOptions; //!< options of a reserved or duplicate flag or long name
+    std::vector<unsigned int> flaggedOptions; //!< options whose error flag was raised by CheckConstraints()
+    std::vector<OperandBase*> operandVector; //!< vector of options
+    unsigned int operandOffset; //!< index in argv of the first operand
+    bool delimited; //!< true if a "--" argument ends the options, see ResolveOperand()
+    bool error; //!< raised to 1 when one of the arguments in the command line is not valid
+    bool lazy; //!< if true, the options added are converted at the first access
+    std::string description; //!< give a general description of the command.
+    std::vector<std::pair<std::string, std::string> > subcommandVector; //!< declared subcommands and their description
+    std::string subcommand; //!< selected subcommand, empty if none
+    bool completing; //!< true for a --yaap-complete request
+    const char* completionWord; //!< word to complete
+    std::string completionShell; //!< shell of a --yaap-complete-script request
+    std::string usageText; //!< rendered usage, see GetUsage()
+    std::vector<char> usageErrors; //!< error flags of the options when usageText was rendered
+    bool usageValid; //!< false if usageText must be rendered again
+    Tokenizer tokenizer; //!< flag and long name tables built from argv
+    Arena arena; //!< storage of the options and operands
+    std::vector<char*> arguments; //!< argument vector after response files expansion
+    std::vector<ResponseFile> responseFiles; //!< buffers of the expanded response files
+#ifdef YAAP_HAS_THREADS
+    std::vector<PendingFile*> pendingFiles; //!< response files read by Prefetch()
+    std::string pendingPath; //!< configuration file read by Prefetch()
+    std::string pendingSnapshotPath; //!< its snapshot path
+    Settings prefetchedConfiguration; //!< its content, once pendingConfiguration is ready
+    std::future<bool> pendingConfiguration; //!< false if it cannot be read
+#endif
+    OptionIndex optionIndex; //!< flag and long name to optionVector index
+    ErrorBuffer errors; //!< errors found while parsing
+    Settings environment; //!< fall-back values from the environment, see UseEnvironment()
+    Settings configuration; //!< fall-back values from the configuration file, see SetConfigFile()
+    std::string fallbackKey; //!< key looked up by Fallback()
+    std::vector<Constraint> constraints; //!< relations between options, see Requires()
+    bool constraintsChecked; //!< true once Validate() checked the values and the constraints
+    ParserStats stats; //!< see Stats()
+    bool dumpStats; //!< if true, PrintStats() is called by the destructor
+};
+
+
+//! \class ResultView
+//! \brief Read-only access to a blob written by Parser::Serialize()
+//!
+//! The view does not copy the blob: it must stay valid (and, for a mapped
+//! memory, mapped) as long as the view is used. Options and operands are
+//! identified by their index, in their order of addition to the Parser.
+class ResultView {
+public:
+    ResultView( ) : data( NULL ) {};
+
+    //! Check the blob [data, data + size) and use it
+    //! \return false if it is not a valid blob
+    bool Attach( const void* data, std::size_t size )
+    {
+        this->data = NULL;
+        const char* bytes = static_cast<const char*>( data );
+        if( size < sizeof( detail::BlobHeader ) || bytes[size - 1] != '\0' )
+            return( false );
+        detail::BlobHeader header;
+        std::memcpy( &header, bytes, sizeof( detail::BlobHeader ) );
+        std::size_t records = sizeof( detail::BlobHeader )
+                            + ( static_cast<std::size_t>( header.nbOptions ) + header.nbOperands ) * sizeof( detail::BlobRecord );
+        if( std::memcmp( header.magic, detail::BlobMagic(), sizeof( header.magic ) ) != 0
+         || header.size != size || records > size || header.arguments > size
+         || header.nbArguments > ( size - header.arguments ) / sizeof( unsigned int ) )
+            return( false );
+        for( unsigned int k = 0; k < header.nbOptions + header.nbOperands; k++ )
+        {
+            detail::BlobRecord record;
+            std::memcpy( &record, bytes + sizeof( detail::BlobHeader ) + k * sizeof( detail::BlobRecord ),
+                         sizeof( detail::BlobRecord ) );
+            if( record.name >= size
+             || ( record.kind != detail::OpaqueBlob
+               && ( record.values > size || record.elementSize == 0
+                 || record.count > ( size - record.values ) / record.elementSize ) ) )
+                return( false );
+        }
+        this->data = bytes;
+        this->header = header;
+        return( true );
+    };
+
+    std::size_t GetNumberOfOptions( ) const {
+        return( this->header.nbOptions );
+    };
+
+    //! Get the index of the option with the given flag, OptionIndex::npos if none
+    unsigned int Find( char flag ) const
+    {
+        for( unsigned int id = 0; id < this->header.nbOptions; id++ )
+            if( this->Record( id ).flag == flag )
+                return( id );
+        return( OptionIndex::npos );
+    };
+
+    //! Get the index of the option with the given long name, OptionIndex::npos if none
+    unsigned int Find( const char* longName ) const
+    {
+        for( unsigned int id = 0; id < this->header.nbOptions; id++ )
+            if( std::strcmp( this->data + this->Record( id ).name, longName ) == 0 )
+                return( id );
+        return( OptionIndex::npos );
+    };
+
+    bool Exists( unsigned int id ) const {
+        return( this->Record( id ).exists != 0 );
+    };
+
+    bool ErrorFlag( unsigned int id ) const {
+        return( this->Record( id ).error != 0 );
+    };
+
+    std::size_t GetNumberOfArguments( unsigned int id ) const {
+        return( this->Record( id ).count );
+    };
+
+    //! Read the pos-th value of the option id
+    //! \return false if it was not stored as a T
+    template<typename T>
+    bool GetArgument( unsigned int id, unsigned int pos, T& value ) const {
+        return( this->Read( this->Record( id ), pos, value ) );
+    };
+
+    //! Get the pos-th value of the option id, T() if it was not stored as a T
+    template<typename T>
+    T GetArgument( unsigned int id, unsigned int pos ) const
+    {
+        T value = T();
+        this->GetArgument( id, pos, value );
+        return( value );
+    };
+
+    //! Convenience function for 1-subarg argument
+    template<typename T>
+    T GetValue( unsigned int id ) const {
+        return( this->GetArgument<T>( id, 0 ) );
+    };
+
+    //! Number of operands added by Parser::AddOperand()
+    std::size_t GetNumberOfOperands( ) const {
+        return( this->header.nbOperands );
+    };
+
+    //! Read the value of the pos-th operand added by Parser::AddOperand()
+    //! \return false if it was not stored as a T
+    template<typename T>
+    bool GetOperand( unsigned int pos, T& value ) const {
+        return( this->Read( this->Record( this->header.nbOptions + pos ), 0, value ) );
+    };
+
+    //! Number of operands following those added by Parser::AddOperand()
+    std::size_t GetNumberOfRemainingOperands( ) const {
+        return( this->header.nbArguments );
+    };
+
+    //! Get the k-th operand following those added by Parser::AddOperand()
+    const char* GetRemainingOperand( unsigned int k ) const
+    {
+        unsigned int offset;
+        std::memcpy( &offset, this->data + this->header.arguments + k * sizeof( unsigned int ), sizeof( unsigned int ) );
+        return( offset < this->header.size ? this->data + offset : "" );
+    };
+
+    bool IsCommandLineValid( ) const {
+        return( this->header.valid != 0 );
+    };
+
+private:
+    detail::BlobRecord Record( unsigned int k ) const
+    {
+        detail::BlobRecord record;
+        std::memcpy( &record, this->data + sizeof( detail::BlobHeader ) + k * sizeof( detail::BlobRecord ),
+                     sizeof( detail::BlobRecord ) );
+        return( record );
+    };
+
+    template<typename T>
+    bool Read( const detail::BlobRecord& record, unsigned int pos, T& value ) const
+    {
+        if( record.kind == detail::OpaqueBlob || record.kind != detail::BlobCodec<T>::Kind()
+         || record.elementSize != detail::BlobElementSize<T>() || pos >= record.count )
+            return( false );
+        if( record.kind == detail::StringBlob )
+        {
+            unsigned int offset;
+            std::memcpy( &offset, this->data + record.values + pos * sizeof( unsigned int ), sizeof( unsigned int ) );
+            if( offset >= this->header.size )
+                return( false );
+        }
+        detail::BlobCodec<T>::Read( this->data, record.values, pos, value );
+        return( true );
+    };
+
+    const char* data; //!< the blob, NULL if none attached
+    detail::BlobHeader header; //!< copy of the blob header
+};
+
+//! \class ParseResult
+//! \brief State of a command line parsed against a yaap::Layout
+//!
+//! Holds, for each option of the layout, its existence, its error flag and the
+//! argv characters of its arguments. Values are converted when they are read.
+//! A ParseResult can be reused for any number of Layout::Parse(): once its
+//! buffers have grown to the size of the largest command line, parsing does
+//! not allocate anymore. With C++17, it is aligned on a cache line so that
+//! results used by different threads never share one.
+class YAAP_CACHE_ALIGNED ParseResult {
+public:
+    ParseResult( ) : argv( NULL ), nbArgs( 0 ), operandOffset( 1 ), error( false ) {};
+
+    //! Forget the last parsed command line, keeping the allocated memory
+    void Reset( )
+    {
+        this->states.clear();
+        this->entries.clear();
+        this->spans.clear();
+        this->argv = NULL;
+        this->nbArgs = 0;
+        this->operandOffset = 1;
+        this->error = false;
+        this->errors.Clear();
+    };
+
+    //! If true, the option id exists in the command line
+    bool Exists( unsigned int id ) const {
+        return( this->states[id].exists );
+    };
+
+    //! If true, the option id is missing while required or has wrong arguments
+    bool ErrorFlag( unsigned int id ) const {
+        return( this->states[id].error );
+    };
+
+    //! Number of occurrences of the option id ("-vvv" counts 3)
+    unsigned int Count( unsigned int id ) const {
+        return( this->states[id].count );
+    };
+
+    //! Number of arguments of the option id, all occurrences included
+    std::size_t GetNumberOfArguments( unsigned int id ) const {
+        return( this->states[id].nbSpans );
+    };
+
+    //! Get the characters of the pos-th argument of the option id
+    Span GetSpan( unsigned int id, unsigned int pos ) const {
+        return( this->spans[this->states[id].firstSpan + pos] );
+    };
+
+    //! Convert the pos-th argument of the option id
+    //! \return false if the conversion failed
+    template<typename T>
+    bool GetArgument( unsigned int id, unsigned int pos, T& value ) const
+    {
+        Span span = this->GetSpan( id, pos );
+        value = T();
+        return( Converter<T>::Convert( span.first, span.last, value ) == span.last );
+    };
+
+    //! Get the pos-th argument of the option id, of type T
+    template<typename T>
+    T GetArgument( unsigned int id, unsigned int pos ) const
+    {
+        T value;
+        this->GetArgument( id, pos, value );
+        return( value );
+    };
+
+    //! Convenience function for 1-subarg argument
+    template<typename T>
+    T GetValue( unsigned int id ) const {
+        return( this->GetArgument<T>( id, 0 ) );
+    };
+
+    //! Get the operands, from the one following the last '--'
+    template<typename T>
+    OperandRange<T> Operands( ) const
+    {
+        unsigned int first = this->operandOffset < this->nbArgs ? this->operandOffset : this->nbArgs;
+        return( OperandRange<T>( this->argv + first, this->argv + this->nbArgs ) );
+    };
+
+    //! Index in argv of the first operand
+    unsigned int OperandOffset( ) const {
+        return( this->operandOffset );
+    };
+
+    bool IsCommandLineValid( ) const {
+        return( !this->error );
+    };
+
+    //! Errors of the command line, in order of detection. Error::option is NULL,
+    //! Error::id is the identifier of the option.
+    const ErrorBuffer& Errors( ) const {
+        return( this->errors );
+    };
+
+private:
+    friend class Layout;
+
+    struct State {
+        bool exists; //!< true if present in the command line
+        bool error; //!< true if missing while required or wrong
+        unsigned int firstSpan; //!< index in spans of the first argument
+        unsigned int nbSpans; //!< number of arguments
+        unsigned int count; //!< number of occurrences
+    };
+
+    //! An argument of an option, in command line order
+    struct Entry {
+        unsigned int id; //!< option identifier
+        Span span; //!< argument characters
+    };
+
+    std::vector<State> states; //!< one state per option of the layout
+    std::vector<Entry> entries; //!< arguments in command line order
+    std::vector<Span> spans; //!< arguments grouped by option
+    char** argv; //!< parsed argument vector
+    unsigned int nbArgs; //!< number of arguments (argc)
+    unsigned int operandOffset; //!< index in argv of the first operand
+    bool error; //!< true if the command line is not valid
+    ErrorBuffer errors; //!< errors of the command line
+};
+
+//! \class Layout
+//! \brief Option layout, independent of any command line
+//!
+//! The options are registered once, then any number of command lines are
+//! parsed into ParseResult objects. The parsing rules are those of Parser.
+//! The type given to AddOptionArg() is used to check the arguments at parse
+//! time; values are converted again when read from the ParseResult.
+//!
+//! Once the options are registered, the layout is not modified by parsing:
+//! const member functions, Parse() included, can be called concurrently from
+//! any number of threads, each one with its own ParseResult and, for Usage(),
+//! its own output stream.
+class Layout {
+public:
+    Layout( std::string description = "" ) : description( description ), valid( true ) {};
+
+    //! Add a simple option. \return its identifier in ParseResult
+    unsigned int AddOption( char flag, std::string longName, std::string description, bool required = false )
+    {
+        return( this->PushDefinition( flag, longName, description, false, 0, required, NULL ) );
+    };
+
+    //! Add an option with nbsubargs arguments of type T (yaap::undef for a
+    //! comma-separated list). \return its identifier in ParseResult
+    template<typename T>
+    unsigned int AddOptionArg( char flag, std::string longName, std::string description, unsigned int nbsubargs, bool required = false )
+    {
+        return( this->PushDefinition( flag, longName, description, true, nbsubargs, required, &Check<T> ) );
+    };
+
+    //! Number of registered options
+    std::size_t GetNumberOfOptions( ) const {
+        return( this->definitions.size() );
+    };
+
+    //! Get the identifier of the option with the given flag, OptionIndex::npos if none
+    unsigned int Find( char flag ) const {
+        return( this->index.Find( flag ) );
+    };
+
+    //! Get the identifier of the option with the given long name, OptionIndex::npos if none
+    unsigned int Find( const char* longName ) const {
+        return( this->index.Find( longName ) );
+    };
+
+    //! If false, a flag is reserved or registered twice
+    bool IsValid( ) const {
+        return( this->valid );
+    };
+
+    void SetDescription( std::string desc ) {
+        this->description = desc;
+    };
+
+    //! Parse the command line into result, which is reset first
+    //! \return result.IsCommandLineValid()
+    bool Parse( int argc, char** argv, ParseResult& result ) const
+    {
+        unsigned int nbArgs = static_cast<unsigned int>( argc );
+        unsigned int nbOptions = static_cast<unsigned int>( this->definitions.size() );
+        result.Reset();
+        result.argv = argv;
+        result.nbArgs = nbArgs;
+        result.error = !this->valid;
+        result.errors = this->errors;
+        ParseResult::State empty = { false, false, 0, 0, 0 };
+        result.states.assign( nbOptions, empty );
+
+        for( unsigned int i = 1; i < nbArgs; i++ )
+        {
+            const char* arg = argv[i];
+            if( arg[0] != '-' )
+                continue;
+            if( arg[1] == '-' && arg[2] == '\0' )
+            {
+                result.operandOffset = i + 1; // last "--" wins, as in Parser
+                continue;
+            }
+            // The option flag can be concatenated after a unique '-'
+            for( unsigned int c = 1; arg[c] != '\0' && arg[c] != '-'; c++ )
+            {
+                unsigned int id = this->index.Find( arg[c] );
+                if( id == OptionIndex::npos )
+                    continue;
+                if( !this->definitions[id].hasArgs )
+                {
+                    result.states[id].exists = true;
+                    result.states[id].count++;
+                }
+                else if( c == 1 ) // options with arguments are first of their cluster
+                    this->ParseOccurrence( id, i, argv, nbArgs, result );
+            }
+            if( arg[1] == '-' )
+            {
+                unsigned int id = this->index.Find( arg + 2 );
+                if( id == OptionIndex::npos )
+                    continue;
+                if( this->definitions[id].hasArgs )
+                    this->ParseOccurrence( id, i, argv, nbArgs, result );
+                else
+                {
+                    result.states[id].exists = true;
+                    result.states[id].count++;
+                }
+            }
+        }
+
+        // group the arguments by option, keeping the command line order
+        for( std::size_t k = 0; k < result.entries.size(); k++ )
+            result.states[result.entries[k].id].nbSpans++;
+        unsigned int offset = 0;
+        for( unsigned int id = 0; id < nbOptions; id++ )
+        {
+            result.states[id].firstSpan = offset;
+            offset += result.states[id].nbSpans;
+            result.states[id].nbSpans = 0;
+        }
+        result.spans.resize( offset );
+        for( std::size_t k = 0; k < result.entries.size(); k++ )
+        {
+            ParseResult::State& state = result.states[result.entries[k].id];
+            result.spans[state.firstSpan + state.nbSpans++] = result.entries[k].span;
+        }
+
+        // if required but not found, raise an error
+        for( unsigned int id = 0; id < nbOptions; id++ )
+            if( this->definitions[id].required && !result.states[id].exists )
+            {
+                result.states[id].error = true;
+                Error error = { Error::MissingRequired, 0, 0, id, NULL };
+                result.errors.Push( error );
+            }
+        for( unsigned int id = 0; id < nbOptions; id++ )
+            if( result.states[id].error )
+                result.error = true;
+        return( result.IsCommandLineValid() );
+    };
+
+    //! Render the usage in text, marking the wrong options of result if given
+    void GetUsage( const char* program, const ParseResult* result, std::string& text ) const
+    {
+        text.clear();
+        detail::AppendUsageHeader( text, program, this->description.c_str() );
+        for( std::size_t id = 0; id < this->definitions.size(); id++ )
+        {
+            const Definition& definition = this->definitions[id];
+            detail::AppendOptionSynopsis( text, definition.flag, definition.longName.c_str(),
+                                          definition.hasArgs, definition.nbArgs );
+        }
+        text += '\n';
+        for( std::size_t id = 0; id < this->definitions.size(); id++ )
+        {
+            const Definition& definition = this->definitions[id];
+            bool error = result && ( result->states.size() <= id || result->states[id].error );
+            detail::AppendOptionLine( text, error, definition.flag, definition.longName.c_str(),
+                                      definition.description.c_str(), definition.required );
+        }
+        detail::AppendUsageFooter( text );
+    };
+
+#ifndef YAAP_NO_IOSTREAM
+    //! Write the usage on out, marking the wrong options of result if given
+    void Usage( const char* program, const ParseResult* result = NULL, std::ostream& out = std::cout ) const
     {
-        this->nbArgs = nbargs;
+        std::string text;
+        this->GetUsage( program, result, text );
+        out.write( text.data(), static_cast<std::streamsize>( text.size() ) );
+        out.flush();
+    };
+#else
+    //! Print the usage, marking the wrong options of result if given
+    void Usage( const char* program, const ParseResult* result = NULL ) const
+    {
+        std::string text;
+        this->GetUsage( program, result, text );
+        detail::WriteOut( text );
     };
+#endif
 
-    //! Add an argument at the end of the arg list
-    void AddArgument( std::istringstream& streamArg );
+private:
+    //! Check that [first, last) converts to a T
+    //! \return a pointer past the last converted character, see Converter
+    typedef const char* ( *CheckFunction )( const char* first, const char* last );
 
-    //! Get the pos-th arg of type T
-    T GetArgument( unsigned int pos ) {
-        return( argVector[pos] );
+    template<typename T>
+    static const char* Check( const char* first, const char* last )
+    {
+        T value = T();
+        return( Converter<T>::Convert( first, last, value ) );
     };
 
-    //! Get the pos-th arg of type T
-    std::size_t GetNumberOfArguments(  )
-    {
-      return(argVector.size());
+    struct Definition {
+        char flag; //!< command line flag character
+        std::string longName; //!< command line long name string
+        std::string description; //!< short description
+        bool hasArgs; //!< false for a simple option
+        unsigned int nbArgs; //!< number of arguments, yaap::undef for a comma list
+        bool required; //!< if true, the option must be in the command line
+        CheckFunction check; //!< argument check, NULL for a simple option
     };
 
-    //! Convenience function for 1-subarg argument
-    T GetValue( ) {
-        return( argVector[0] );
+    unsigned int PushDefinition( char flag, const std::string& longName, const std::string& description,
+                                 bool hasArgs, unsigned int nbArgs, bool required, CheckFunction check )
+    {
+        unsigned int id = static_cast<unsigned int>( this->definitions.size() );
+        Definition definition = { flag, longName, description, hasArgs, nbArgs, required, check };
+        this->definitions.push_back( definition );
+        Error error = { Error::ReservedFlag, 0, 0, id, NULL };
+        if( flag == 'W' || flag == '-' )
+            this->errors.Push( error );
+        else if( !this->index.Insert( flag, longName, id ) )
+        {
+            error.code = Error::DuplicateOption;
+            this->errors.Push( error );
+        }
+        this->valid = this->errors.empty();
+        return( id );
     };
 
-    //! Print how to use the option in the command line format
-    virtual void CLUsage( )
+    //! Record the arguments of the option id found in argv[i]
+    void ParseOccurrence( unsigned int id, unsigned int i, char** argv, unsigned int nbArgs, ParseResult& result ) const
     {
-        std::cout << " [-" << this->Flag()<<"/--"<<this->LongName();
-        if( this->nbArgs == yaap::undef )
-            std::cout << " x1,x2,...";
-        else
-            for( unsigned int i = 0; i < nbArgs; i++ )
+        const Definition& definition = this->definitions[id];
+        ParseResult::State& state = result.states[id];
+        state.exists = true;
+        state.count++;
+        if( i + ( definition.nbArgs == yaap::undef ? 1 : definition.nbArgs ) >= nbArgs )
+        {
+            state.error = true;
+            Error error = { Error::MissingArgument, i, 0, id, NULL };
+            result.errors.Push( error );
+            return;
+        }
+        ParseResult::Entry entry;
+        entry.id = id;
+        if( definition.nbArgs == yaap::undef )
+        {
+            const char* arg = argv[i + 1];
+            const char* end = arg + std::strlen( arg );
+            while( arg != end )
             {
-              std::cout << " x";
-              if( nbArgs > 1)
-              {
-                std::cout << i+1;
-              }
+                const char* comma = detail::FindByte( arg, end, ',' );
+                entry.span.first = arg;
+                entry.span.last = comma;
+                const char* stop = definition.check( arg, comma );
+                if( stop != comma )
+                    RecordBadValue( id, i + 1, argv, stop, result );
+                result.entries.push_back( entry );
+                arg = ( comma == end ) ? end : comma + 1;
             }
-        std::cout << "]";
+            return;
+        }
+        for( unsigned int argIdx = 1; argIdx <= definition.nbArgs; argIdx++ )
+        {
+            const char* arg = argv[i + argIdx];
+            entry.span.first = arg;
+            entry.span.last = arg + std::strlen( arg );
+            const char* stop = definition.check( entry.span.first, entry.span.last );
+            if( stop != entry.span.last )
+                RecordBadValue( id, i + argIdx, argv, stop, result );
+            result.entries.push_back( entry );
+        }
     };
 
-protected:
-    unsigned int nbArgs; //!< Number of arguments of this specific option
-    std::vector<T> argVector; //!< Vector of arguments of type T
+    //! Raise the error of the option id, whose argument argv[argIndex] does
+    //! not convert from stop on
+    static void RecordBadValue( unsigned int id, unsigned int argIndex, char** argv,
+                                const char* stop, ParseResult& result )
+    {
+        result.states[id].error = true;
+        Error error = { Error::BadValue, argIndex, static_cast<unsigned int>( stop - argv[argIndex] ), id, NULL };
+        result.errors.Push( error );
+    };
+
+    std::vector<Definition> definitions; //!< registered options, by identifier
+    OptionIndex index; //!< flag and long name to identifier
+    ErrorBuffer errors; //!< errors of the registered options
+    std::string description; //!< general description of the command
+    bool valid; //!< false if a flag is reserved or registered twice
+};
+
+#ifdef YAAP_HAS_CXX17
+
+//! \struct Field
+//! \brief Compile-time declaration of an option of a yaap::Schema
+//!
+//! T is the type of the option-arguments (void for a simple option), N their
+//! number (yaap::undef for a comma-separated list) and R the requirement level.
+//! The long name and the description are given as static members:
+//! \code
+//! struct Spacing : yaap::Field<'s', double, 3, true> {
+//!     static constexpr const char* longName = "spacing";
+//!     static constexpr const char* description = "Spacing: x y z (double)";
+//! };
+//! \endcode
+template<char F, typename T = void, unsigned int N = 1, bool R = false>
+struct Field {
+    typedef T type;
+    static constexpr char flag = F;
+    static constexpr bool isSwitch = std::is_void<T>::value;
+    static constexpr unsigned int nbArgs = std::is_void<T>::value ? 0 : N;
+    static constexpr bool required = R;
 };
 
-//! Template specialization of SetArgument - general definition
+namespace detail {
+
+//! Type of the value of a field in Schema::Result
+template<typename T, unsigned int N> struct FieldValue { typedef std::array<T, N> type; };
+template<typename T> struct FieldValue<T, 1> { typedef T type; };
+template<typename T> struct FieldValue<T, yaap::undef> { typedef std::vector<T> type; };
+template<> struct FieldValue<void, 0> { typedef bool type; };
+
+//! Convert [first, last) with yaap::Converter. \return true on success
 template<typename T>
-void OptionArg<T>::AddArgument( std::istringstream& streamArg )
+bool FromString( const char* first, const char* last, T& value )
 {
-    T arg;
-    streamArg >> arg;
-    if( streamArg.fail())
-    {
-        this->RaiseError();
-    }
+    return( Converter<T>::Convert( first, last, value ) == last );
+}
 
-    this->argVector.push_back( arg );
+constexpr std::size_t StrLen( const char* s )
+{
+    std::size_t n = 0;
+    while( s[n] != '\0' )
+        n++;
+    return( n );
 }
 
-//! Template specialization of SetArgument - istd::string definition
-template<>
-void OptionArg<std::string>::AddArgument( std::istringstream& streamArg )
+constexpr int StrCmp( const char* a, const char* b )
 {
-    std::string arg;
-    std::getline(streamArg, arg);
+    while( *a != '\0' && *a == *b )
+    {
+        a++;
+        b++;
+    }
+    return( static_cast<unsigned char>( *a ) - static_cast<unsigned char>( *b ) );
+}
 
-    if( streamArg.fail())
+constexpr std::size_t DigitCount( unsigned int n )
+{
+    std::size_t d = 1;
+    while( n >= 10 )
     {
-        this->RaiseError();
+        n /= 10;
+        d++;
     }
+    return( d );
+}
 
-    this->argVector.push_back( arg );
+template<typename... Opts>
+constexpr bool HasReservedFlag( )
+{
+    const char flags[] = { Opts::flag..., 'a' };
+    for( std::size_t i = 0; i < sizeof...( Opts ); i++ )
+        if( flags[i] == 'W' || flags[i] == '-' )
+            return( true );
+    return( false );
 }
 
-//! Template specialization of SetArgument - unsigned int definition
-//! Uint data should be passed as hexadecimal, prefix '0x'
-template<>
-void OptionArg<unsigned int>::AddArgument( std::istringstream& streamArg )
+template<typename... Opts>
+constexpr bool HasDuplicateFlag( )
+{
+    const char flags[] = { Opts::flag..., 'a' };
+    for( std::size_t i = 0; i < sizeof...( Opts ); i++ )
+        for( std::size_t j = i + 1; j < sizeof...( Opts ); j++ )
+            if( flags[i] != '\0' && flags[i] == flags[j] )
+                return( true );
+    return( false );
+}
+
+template<typename... Opts>
+constexpr bool HasDuplicateLongName( )
+{
+    const char* names[] = { Opts::longName..., "" };
+    for( std::size_t i = 0; i < sizeof...( Opts ); i++ )
+        for( std::size_t j = i + 1; j < sizeof...( Opts ); j++ )
+            if( names[i][0] != '\0' && StrCmp( names[i], names[j] ) == 0 )
+                return( true );
+    return( false );
+}
+
+//! Flag to field index table, 0xFF for unknown flags
+template<typename... Opts>
+constexpr std::array<unsigned char, 256> MakeFlagTable( )
 {
-    std::string stringArg;
-    streamArg >> stringArg;
+    std::array<unsigned char, 256> table{};
+    for( std::size_t f = 0; f < 256; f++ )
+        table[f] = 0xFF;
+    const char flags[] = { Opts::flag..., 'a' };
+    for( std::size_t i = 0; i < sizeof...( Opts ); i++ )
+        if( flags[i] != '\0' )
+            table[static_cast<unsigned char>( flags[i] )] = static_cast<unsigned char>( i );
+    return( table );
+}
 
-    bool hexa = false;
-    if( stringArg.find("0x") == 0 ) // hexa prefix has been found at first position
+//! Field indices sorted by long name
+template<typename... Opts>
+constexpr std::array<unsigned char, sizeof...( Opts )> MakeLongNameOrder( )
+{
+    std::array<unsigned char, sizeof...( Opts )> order{};
+    const char* names[] = { Opts::longName..., "" };
+    for( std::size_t i = 0; i < sizeof...( Opts ); i++ )
     {
-        hexa = true;
-        stringArg = stringArg.substr(2);
+        std::size_t j = i;
+        while( j > 0 && StrCmp( names[order[j - 1]], names[i] ) > 0 )
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = static_cast<unsigned char>( i );
     }
+    return( order );
+}
+
+template<typename... Opts>
+constexpr std::uint64_t MakeRequiredMask( )
+{
+    const bool required[] = { Opts::required..., false };
+    std::uint64_t mask = 0;
+    for( std::size_t i = 0; i < sizeof...( Opts ); i++ )
+        if( required[i] )
+            mask |= std::uint64_t( 1 ) << i;
+    return( mask );
+}
 
-    std::istringstream newStream( stringArg ); // new stream with argument without prefix (if any)
+//! Length of the command line usage of a field, see Option::CLUsage()
+template<typename O>
+constexpr std::size_t SynopsisLength( )
+{
+    // " [-f/--name]", see AppendOptionNames()
+    const bool hasFlag = O::flag != '\0', hasLongName = O::longName[0] != '\0';
+    std::size_t n = 2 + ( hasFlag ? 2 : 0 ) + ( hasFlag && hasLongName ? 1 : 0 )
+                  + ( hasLongName ? 2 + StrLen( O::longName ) : 0 ) + 1;
+    if( O::isSwitch )
+        return( n );
+    if( O::nbArgs == yaap::undef )
+        return( n + StrLen( " x1,x2,..." ) );
+    for( unsigned int i = 0; i < O::nbArgs; i++ )
+        n += 2 + ( O::nbArgs > 1 ? DigitCount( i + 1 ) : 0 );
+    return( n );
+}
 
-    unsigned int arg;
-    if( hexa == true )
-        newStream >> std::hex >> arg;
-    else
-        newStream >> arg;
+template<std::size_t L>
+constexpr void Put( std::array<char, L>& out, std::size_t& pos, const char* s )
+{
+    while( *s != '\0' )
+        out[pos++] = *s++;
+}
 
-    if( newStream.fail())
+template<std::size_t L>
+constexpr void PutNumber( std::array<char, L>& out, std::size_t& pos, unsigned int n )
+{
+    std::size_t d = DigitCount( n );
+    for( std::size_t k = d; k > 0; k-- )
     {
-        this->RaiseError();
+        out[pos + k - 1] = static_cast<char>( '0' + n % 10 );
+        n /= 10;
     }
+    pos += d;
+}
 
-    this->argVector.push_back( arg );
+template<typename O, std::size_t L>
+constexpr void WriteSynopsis( std::array<char, L>& out, std::size_t& pos )
+{
+    Put( out, pos, " [" );
+    if( O::flag != '\0' )
+    {
+        out[pos++] = '-';
+        out[pos++] = O::flag;
+        if( O::longName[0] != '\0' )
+            out[pos++] = '/';
+    }
+    if( O::longName[0] != '\0' )
+    {
+        Put( out, pos, "--" );
+        Put( out, pos, O::longName );
+    }
+    if( !O::isSwitch )
+    {
+        if( O::nbArgs == yaap::undef )
+            Put( out, pos, " x1,x2,..." );
+        else
+            for( unsigned int i = 0; i < O::nbArgs; i++ )
+            {
+                Put( out, pos, " x" );
+                if( O::nbArgs > 1 )
+                    PutNumber( out, pos, i + 1 );
+            }
+    }
+    Put( out, pos, "]" );
 }
 
-//! \class OperandBase
-//! \brief define a command line operand
-//! 
-//! This is a bare base class intended to be used as std::vector element. 
-//! \see Operand<T>
-class OperandBase{
-public:
-    OperandBase( const std::string& description){
-        this->description = description;
-    };
-    virtual ~OperandBase(){};
-private:
-    std::string description; //!< short description of the operand's role
-};    
+template<std::size_t L, typename... Opts>
+constexpr std::array<char, L> MakeSynopsis( )
+{
+    std::array<char, L> out{};
+    std::size_t pos = 0;
+    ( WriteSynopsis<Opts>( out, pos ), ... );
+    out[pos] = '\0';
+    return( out );
+}
 
-//! \class Operand
-//! \brief Implement a defined type for a command line operand
-template<typename T>
-class Operand : public OperandBase{
+} // namespace detail
+
+//! \class Schema
+//! \brief Option layout fixed at compile time
+//!
+//! The options are given as a list of yaap::Field types. Flag table, long name
+//! index, usage synopsis and required-options mask are computed at compile
+//! time; flag collisions and reserved flags are compilation errors. Parse()
+//! fills a Result holding one typed value per field, without virtual calls
+//! nor allocation (except for std::string and comma-separated list values).
+template<typename... Opts>
+class Schema {
 public:
-    Operand( const std::string& description ):OperandBase( description ){
-    };
+    static constexpr std::size_t size = sizeof...( Opts ); //!< number of fields
+    static_assert( size <= 64, "yaap::Schema: at most 64 options are supported" );
+    static_assert( !detail::HasReservedFlag<Opts...>(), "yaap::Schema: 'W' and '-' are reserved flags" );
+    static_assert( !detail::HasDuplicateFlag<Opts...>(), "yaap::Schema: duplicate flag" );
+    static_assert( !detail::HasDuplicateLongName<Opts...>(), "yaap::Schema: duplicate long name" );
 
-    void SetValue( std::istringstream& valStream );
-    
+    //! Flag to field index, 0xFF for unknown flags
+    static constexpr std::array<unsigned char, 256> flagTable = detail::MakeFlagTable<Opts...>();
+    //! Field indices sorted by long name
+    static constexpr std::array<unsigned char, size> longNameOrder = detail::MakeLongNameOrder<Opts...>();
+    //! Bit i is set if the i-th field is required
+    static constexpr std::uint64_t requiredMask = detail::MakeRequiredMask<Opts...>();
+    //! Command line format of the options, as printed by Usage()
+    static constexpr std::size_t synopsisLength = ( std::size_t( 0 ) + ... + detail::SynopsisLength<Opts>() );
+    static constexpr std::array<char, synopsisLength + 1> synopsis = detail::MakeSynopsis<synopsisLength + 1, Opts...>();
 
-    T GetValue( ){
-        return( this->value );
+    //! Get the index of field O in the schema
+    template<typename O>
+    static constexpr std::size_t IndexOf( )
+    {
+        const bool same[] = { std::is_same<O, Opts>::value..., false };
+        std::size_t i = 0;
+        while( i < size && !same[i] )
+            i++;
+        return( i );
     };
 
-private:
-    T value;
-};
+    //! \class Result
+    //! \brief Typed values of a parsed command line
+    class Result {
+    public:
+        Result( ) : present( 0 ), errors( 0 ), unknown( 0 ), operandOffset( 1 ) {};
 
-//! Template specialization for string operand (white space hack)
-template<typename T>
-void Operand<T>::SetValue( std::istringstream& valStream )
-{
-    valStream >> this->value;
-}
+        //! Get the value of field O: bool for a simple option, T for one
+        //! option-argument, std::array<T,N> for N, std::vector<T> for yaap::undef
+        template<typename O>
+        typename detail::FieldValue<typename O::type, O::nbArgs>::type& Get( )
+        {
+            static_assert( IndexOf<O>() < size, "yaap::Schema: not a field of this schema" );
+            return( std::get<IndexOf<O>()>( this->values ) );
+        };
 
-//! Template specialization for string operand (white space hack)
-template<>
-void Operand<std::string>::SetValue( std::istringstream& valStream )
-{
-    std::getline( valStream, this->value );
-}
-//! \class Parser
-//! \brief Manages a set of options
-class Parser {
-public:
-    //! constructor. Initializes number of args and argument vector.
-    Parser( int argc, char** argv, std::string description = "" )
-    {
-        this->nbArgs = argc;
-        this->argv = argv;
-        this->error = false;
-        this->description = description;
-  
-        this->operandOffset = 1; // Case with no option
-        // find the first possible operand (use of "--" flag)
-        for( int argId = 0; argId < argc; argId++ )
+        //! If true, field O exists in the command line
+        template<typename O>
+        bool Exists( ) const
         {
-            if( argv[argId][0] == '-' )
-                if( argv[argId][1] == '-' )
-                    if( argv[argId][2] == '\0' )
-                    {
-                        this->operandOffset = argId+1;
-                    }
-        }
-    };
+            static_assert( IndexOf<O>() < size, "yaap::Schema: not a field of this schema" );
+            return( ( this->present >> IndexOf<O>() ) & 1 );
+        };
 
-    //! destructor
-    virtual ~Parser()
-    {
-        // todo: delete options
-        std::vector<Option*>::iterator optionIterator = this->optionVector.begin(); 
-        while( optionIterator != this->optionVector.end() )
+        //! If true, field O is missing while required or has wrong arguments
+        template<typename O>
+        bool ErrorFlag( ) const
         {
-            delete *optionIterator;
-            optionIterator++;
-        }
+            static_assert( IndexOf<O>() < size, "yaap::Schema: not a field of this schema" );
+            return( ( this->errors >> IndexOf<O>() ) & 1 );
+        };
+
+        //! Index in argv of the first unknown option, 0 if none
+        int UnknownArgument( ) const {
+            return( this->unknown );
+        };
+
+        //! Index in argv of the first operand
+        int OperandOffset( ) const {
+            return( this->operandOffset );
+        };
+
+        bool IsCommandLineValid( ) const {
+            return( this->errors == 0 && this->unknown == 0 );
+        };
+
+    private:
+        friend class Schema;
+        std::uint64_t present; //!< bit i is set if the i-th field exists
+        std::uint64_t errors; //!< bit i is set if the i-th field is wrong
+        int unknown; //!< index in argv of the first unknown option
+        int operandOffset; //!< index in argv of the first operand
+        std::tuple<typename detail::FieldValue<typename Opts::type, Opts::nbArgs>::type...> values;
     };
 
-    //! Add a simple option with given flag and description to the options
-    //! vector and check its existence.
-    //! \return the instanciated Option
-    Option* AddOption( char flag, std::string longName, std::string description, bool required = false )
+    //! Parse the command line into result. Options and their arguments are
+    //! read up to '--' or to the first operand.
+    //! \return true if the command line is valid
+    static bool Parse( int argc, char** argv, Result& result )
     {
-        Option* option = new Option( flag, longName, description );
-        option->SetRequired( required );
-        // For each argument in the command, check the underlying string
-        for( unsigned int i = 1; i < this->nbArgs; i++ )
+        static constexpr std::array<ParseFunction, size> dispatch = MakeDispatch( std::index_sequence_for<Opts...>() );
+        result = Result();
+        int i = 1;
+        for( ; i < argc; i++ )
         {
-            if( this->argv[i][0] == '-' ) // This is an option(s) statement
+            const char* arg = argv[i];
+            if( arg[0] != '-' || arg[1] == '\0' ) // first operand
+                break;
+            if( arg[1] == '-' )
             {
-                // The option flag can be concatenated after a unique '-'
-                unsigned int c = 1;
-                while(argv[i][c] != '\0' && argv[i][c]!='-')
+                if( arg[2] == '\0' ) // end of options
                 {
-                    if( argv[i][c] == option->Flag() ) // It is the processed option
-                        option->Exists(true); // toggle the state in the Option object
-                    c++;
+                    i++;
+                    break;
                 }
+                std::size_t id = FindLongName( arg + 2 );
+                if( id == size )
+                {
+                    if( result.unknown == 0 )
+                        result.unknown = i;
+                    continue;
+                }
+                i = dispatch[id]( i, i, argc, argv, result );
             }
-            if( option->LongName().compare(argv[i]+2) == 0)
-            {
-              option->Exists(true);
-            }
-        }
-        // Put the Option in the options' array.
-        this->PushOption( option );
-        // if required but not found, raise an error
-        if( !option->Exists() && required )
-        {
-            option->RaiseError( );
-            this->error = true;
-        }
-        // Return the created Option for the user to use it in the main program
-        return( option );
-    };
-
-    //! Add an option with arguments with given flag and description to the
-    //! options vector, check its existence and perform the sub-arguments
-    //! assignment. There are nsubargs of type T.
-    //! \return the instanciated OptionArg
-    template<class T>
-    OptionArg<T>* AddOptionArg( char flag, std::string longName, std::string description, unsigned int nbsubargs, bool required = false )
-    {
-        // option allocation
-        OptionArg<T>* option = new OptionArg<T>( flag, longName, description, nbsubargs );
-        option->SetRequired( required);
-
-        // parse the argument list
-        for( unsigned int i = 1; i < this->nbArgs; i++ )
-        {
-            if( this->argv[i][0] == '-' ) // This is an option(s) statement
+            else
             {
-                if( argv[i][1] == option->Flag() 
-                  || option->LongName().compare(argv[i]+2) == 0
-                   ) // this is the processed option
+                // a cluster of flags; option-arguments follow the cluster
+                int last = i;
+                for( unsigned int c = 1; arg[c] != '\0'; c++ )
                 {
-                    // toggle the state of the option to true
-                    option->Exists(true);
-                    if( i + nbsubargs >= this->nbArgs )
+                    unsigned char id = flagTable[static_cast<unsigned char>( arg[c] )];
+                    if( id == 0xFF )
                     {
-                        option->RaiseError();
-                        this->error = true;
-                    }
-                    else
-                    {
-                      // If nb of option-arguments is unknown, get the arguments
-                      // with comma-separated split
-                      if( nbsubargs == yaap::undef )
-                      {
-                        std::stringstream args(argv[i + 1]);
-                        std::string arg;
-                        while( std::getline( args, arg, ',' ) )
-                        {
-                          std::istringstream argStream( arg );
-                          option->AddArgument( argStream );
-                        }
-                      }
-                      else
-                      {
-                        for( unsigned int argIdx = 1; argIdx <= nbsubargs; argIdx++ )
-                        {
-                          // For each sub-argument, memorize the command line value in
-                          // the OptionArg object
-                          std::istringstream argStream( argv[i + argIdx] );
-                          option->AddArgument( argStream );
-                          if( option->ErrorFlag() )
-                            this->error = true;
-                        }
-
-                      }
+                        if( result.unknown == 0 )
+                            result.unknown = i;
+                        continue;
                     }
+                    last = dispatch[id]( i, last, argc, argv, result );
                 }
+                i = last;
             }
         }
-        // Put the Option in the options' array.
-        this->PushOption( option );
-        // if required but not found, raise an error
-        if( !option->Exists() && required )
-        {
-            this->error = true;
-            option->RaiseError();
-        }
-        // Return the created Option for the user to use it in the main program
-        return( option );
+        result.operandOffset = i;
+        result.errors |= requiredMask & ~result.present;
+        return( result.IsCommandLineValid() );
     };
 
-    template<typename T>
-    Operand<T>* AddOperand( std::string description ){
-
-        Operand<T>* op = new Operand<T>(description);
-
-        if( this->operandOffset >= this->nbArgs )
+    //! Answer a shell completion request (see Parser::Complete()) from the
+    //! compile-time tables, before any other initialization.
+    //! \return true if the command line was a completion request
+    static bool Complete( int argc, char** argv )
+    {
+        std::string out;
+        if( argc >= 2 && std::strcmp( argv[1], "--yaap-complete-script" ) == 0 )
         {
-            this->error = true;
-            std::istringstream nullStream( "0" );
-            op->SetValue( nullStream );
+            if( !detail::AppendCompletionScript( argc >= 3 ? argv[2] : "bash", argv[0], out ) )
+                out = "unknown shell (bash, zsh or fish)\n";
+            detail::WriteOut( out );
+            return( true );
         }
-        else
+        if( argc < 2 || std::strcmp( argv[1], "--yaap-complete" ) != 0 )
+            return( false );
+        const char* word = argc >= 3 ? argv[argc - 1] : "";
+        const char flags[] = { Opts::flag..., 'a' };
+        const char* longNames[] = { Opts::longName..., "" };
+        if( word[0] == '\0' || ( word[0] == '-' && word[1] == '\0' ) )
+            for( std::size_t i = 0; i < size; i++ )
+                if( flags[i] != '\0' )
+                    ( ( out += '-' ) += flags[i] ) += '\n';
+        if( word[0] == '\0' || word[0] == '-' )
         {
-            std::istringstream opStream( this->argv[this->operandOffset] );
-            op->SetValue( opStream );
+            // long names are sorted at compile time: the matches are contiguous
+            const char* prefix = word[0] == '\0' ? "" : ( word[1] == '-' ? word + 2 : word + 1 );
+            if( word[0] == '-' && word[1] != '-' && word[1] != '\0' )
+                prefix = NULL; // a cluster of flags
+            std::size_t length = prefix ? std::strlen( prefix ) : 0;
+            std::size_t first = 0, last = size;
+            while( prefix && first < last )
+            {
+                std::size_t middle = first + ( last - first ) / 2;
+                if( std::strcmp( longNames[longNameOrder[middle]], prefix ) < 0 )
+                    first = middle + 1;
+                else
+                    last = middle;
+            }
+            for( ; prefix && first < size; first++ )
+            {
+                const char* name = longNames[longNameOrder[first]];
+                if( std::strncmp( name, prefix, length ) != 0 )
+                    break;
+                if( name[0] != '\0' ) // no long name, sorted first
+                    ( ( out += "--" ) += name ) += '\n';
+            }
         }
-        this->operandVector.push_back( op );
-        this->operandOffset++;
-        return( op );
+        detail::WriteOut( out );
+        return( true );
     };
 
-    OperandBase* GetOperand( unsigned int pos ){
-        return( this->operandVector[pos] );
+    //! Render the usage in text, marking the wrong options of result if given
+    static void GetUsage( const char* program, const std::string& description, const Result* result, std::string& text )
+    {
+        const char flags[] = { Opts::flag..., 'a' };
+        const char* longNames[] = { Opts::longName..., "" };
+        const char* descriptions[] = { Opts::description..., "" };
+        text.clear();
+        detail::AppendUsageHeader( text, program, description.c_str() );
+        ( text += synopsis.data() ) += '\n';
+        for( std::size_t i = 0; i < size; i++ )
+            detail::AppendOptionLine( text, result && ( ( result->errors >> i ) & 1 ), flags[i], longNames[i],
+                                      descriptions[i], ( requiredMask >> i ) & 1 );
+        detail::AppendUsageFooter( text );
     };
 
-    void Usage( )
+    //! Print the usage on the standard output, with a single write
+    static void Usage( const char* program, const std::string& description = "", const Result* result = nullptr )
     {
-        std::cout <<std::endl<< "Utility " << this->argv[0] << " :" << std::endl;
-        std::cout << std::endl<<this->description << std::endl;
-        std::cout << std::endl<<"Usage: \n [shell]$ " << this->argv[0];
-        for( unsigned int i = 0; i < optionVector.size(); i++ )
-            optionVector[i]->CLUsage();
-        std::cout << std::endl;
-
-        for( unsigned int i = 0; i < optionVector.size(); i++ )
-        {
-            std::string requirement;
-            if( optionVector[i]->IsRequired( ))
-                requirement = "Required";
-            else
-                requirement = "Optional";
-
-            if( optionVector[i]->ErrorFlag() )
-                std::cout << "     *\t";
-            else
-                std::cout << "\t";
-            std::cout << "-" << optionVector[i]->Flag()
-                      << "/--" << optionVector[i]->LongName()
-                      << " : " << optionVector[i]->GetDescription()
-                      << " ("<<requirement<<")."<<std::endl;
-        }
-        std::cout << "* indicate(s) wrong argument(s)."<< std::endl;
+        std::string text;
+        GetUsage( program, description, result, text );
+        detail::WriteOut( text );
     };
 
-    bool IsCommandLineValid( )
+private:
+    //! Parse the field found in argv[argId] whose option-arguments follow
+    //! argv[last]. \return the index of the last consumed argument
+    typedef int ( *ParseFunction )( int argId, int last, int argc, char** argv, Result& result );
+
+    template<std::size_t... I>
+    static constexpr std::array<ParseFunction, size> MakeDispatch( std::index_sequence<I...> )
     {
-        return( !this->error );
+        return( std::array<ParseFunction, size>{ { &ParseField<I>... } } );
     };
 
-    void SetDescription( std::string desc )
+    //! Binary search of name in the long names. \return size if not found
+    static std::size_t FindLongName( const char* name )
     {
-        this->description = desc;
+        const char* longNames[] = { Opts::longName..., "" };
+        std::size_t first = 0, last = size;
+        while( first < last )
+        {
+            std::size_t middle = first + ( last - first ) / 2;
+            int cmp = std::strcmp( longNames[longNameOrder[middle]], name );
+            if( cmp == 0 )
+                return( longNameOrder[middle] );
+            if( cmp < 0 )
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return( size );
     };
 
-private:
-    void PushOption( Option* option ){
-        this->optionVector.push_back( option );
-        if( // Reserved POSIX flags
-            option->Flag() == 'W'
-         || option->Flag() == '-'
-          ) 
+    template<std::size_t I>
+    static int ParseField( int /*argId*/, int last, int argc, char** argv, Result& result )
+    {
+        typedef typename std::tuple_element<I, std::tuple<Opts...> >::type O;
+        const std::uint64_t bit = std::uint64_t( 1 ) << I;
+        auto& value = std::get<I>( result.values );
+        result.present |= bit;
+        if constexpr( O::isSwitch )
         {
-            option->RaiseError( );
-            this->error = true;
+            value = true;
+            return( last );
+        }
+        else if constexpr( O::nbArgs == yaap::undef )
+        {
+            if( last + 1 >= argc )
+            {
+                result.errors |= bit;
+                return( last );
+            }
+            // comma-separated option-arguments
+            const char* first = argv[last + 1];
+            const char* end = first + std::strlen( first );
+            value.reserve( detail::CountByte( first, end, ',' ) + 1 );
+            while( first != end )
+            {
+                const char* comma = detail::FindByte( first, end, ',' );
+                typename O::type arg{};
+                if( !detail::FromString( first, comma, arg ) )
+                    result.errors |= bit;
+                value.push_back( arg );
+                first = ( comma == end ) ? end : comma + 1;
+            }
+            return( last + 1 );
+        }
+        else
+        {
+            if( last + static_cast<int>( O::nbArgs ) >= argc )
+            {
+                result.errors |= bit;
+                return( argc - 1 );
+            }
+            for( unsigned int k = 0; k < O::nbArgs; k++ )
+            {
+                const char* arg = argv[last + 1 + k];
+                bool ok;
+                if constexpr( O::nbArgs == 1 )
+                    ok = detail::FromString( arg, arg + std::strlen( arg ), value );
+                else
+                    ok = detail::FromString( arg, arg + std::strlen( arg ), value[k] );
+                if( !ok )
+                    result.errors |= bit;
+            }
+            return( last + O::nbArgs );
         }
     };
+};
 
+#endif // YAAP_HAS_CXX17
 
-    unsigned int nbArgs; //!< Number of arguments (argc)
-    char** argv; //!< Arguments' vector
-    std::vector<Option*> optionVector; //!< vector of options
-    std::vector<OperandBase*> operandVector; //!< vector of options
-    unsigned int operandOffset; //!< index in argv of the first operand
-    bool error; //!< raised to 1 when one of the arguments in the command line is not valid
-    std::string description; //!< give a general description of the command.
-};
+// With YAAP_EXTERN_TEMPLATES (set by the yaap library target of CMake), the
+// options and operands of the common types are instantiated once, in
+// yaap.cxx, instead of in every translation unit that uses them.
+#define YAAP_INSTANTIATE( prefix, T ) \
+    prefix template class OptionArg<T>; \
+    prefix template class Operand<T>; \
+    prefix template OptionArg<T>* Parser::AddOptionArg<T>( char, std::string, std::string, unsigned int, bool ); \
+    prefix template OptionArg<T>* Parser::ParseOptionArg<T>( char, std::string, std::string, unsigned int, bool, T*, std::size_t ); \
+    prefix template void Parser::ResolveOptionArg<T>( Option*, unsigned int ); \
+    prefix template Operand<T>* Parser::AddOperand<T>( std::string );
+#define YAAP_INSTANTIATE_ALL( prefix ) \
+    YAAP_INSTANTIATE( prefix, int ) \
+    YAAP_INSTANTIATE( prefix, unsigned int ) \
+    YAAP_INSTANTIATE( prefix, long ) \
+    YAAP_INSTANTIATE( prefix, unsigned long ) \
+    YAAP_INSTANTIATE( prefix, float ) \
+    YAAP_INSTANTIATE( prefix, double ) \
+    YAAP_INSTANTIATE( prefix, std::string )
 
+#if defined( YAAP_EXTERN_TEMPLATES ) && !defined( YAAP_INSTANTIATE_TEMPLATES )
+YAAP_INSTANTIATE_ALL( extern )
+#endif
 
 }; //end namespace yaap
 